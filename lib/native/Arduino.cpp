@@ -0,0 +1,152 @@
+#include <Arduino.h>
+#include <esp_timer.h>
+#include <stdarg.h>
+#include <malloc.h>
+#include <chrono>
+
+HardwareSerial Serial;
+EspClass ESP;
+
+// noon on 1 Jan 2025 unless the host driver says otherwise
+time_t native_epoch = 1735732800;
+
+// ----- timing -----
+
+unsigned long millis()
+{
+    return native_micros() / 1000;
+}
+
+unsigned long micros()
+{
+    return native_micros();
+}
+
+void delay(unsigned long ms)
+{
+    vTaskDelay(pdMS_TO_TICKS(ms));
+}
+
+int64_t esp_timer_get_time()
+{
+    static const auto start = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+long map(long x, long in_min, long in_max, long out_min, long out_max)
+{
+    return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
+
+// ----- random numbers -----
+// xorshift32 so runs are reproducible: esp_random() is deterministic on the host
+
+static uint32_t hardwareRandom = 0x9E3779B9;
+static uint32_t arduinoRandom = 0x2545F491;
+
+static uint32_t xorshift32(uint32_t &state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+uint32_t esp_random()
+{
+    return xorshift32(hardwareRandom);
+}
+
+void randomSeed(unsigned long seed)
+{
+    if (seed)
+        arduinoRandom = seed;
+}
+
+long random(long howbig)
+{
+    if (howbig <= 0)
+        return 0;
+    return xorshift32(arduinoRandom) % howbig;
+}
+
+long random(long howsmall, long howbig)
+{
+    if (howsmall >= howbig)
+        return howsmall;
+    return random(howbig - howsmall) + howsmall;
+}
+
+// ----- Serial -----
+
+size_t HardwareSerial::printf(const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    int n = vprintf(format, args);
+    va_end(args);
+    return n < 0 ? 0 : n;
+}
+
+size_t HardwareSerial::println(const struct tm *timeinfo, const char *format)
+{
+    char buffer[64];
+    size_t n = strftime(buffer, sizeof(buffer), format ? format : "%c", timeinfo);
+    buffer[n] = 0;
+    return print(buffer) + print('\n');
+}
+
+// ----- time -----
+
+bool getLocalTime(struct tm *info, uint32_t ms)
+{
+    time_t now = native_epoch + (time_t)(native_micros() / 1000000);
+    return localtime_r(&now, info) != nullptr;
+}
+
+void configTime(long gmtOffset_sec, int daylightOffset_sec, const char *server1, const char *server2, const char *server3)
+{
+    // POSIX offsets are west of UTC, the ESP32 ones east (daylight saving isn't modeled)
+    char tz[32];
+    snprintf(tz, sizeof(tz), "UTC%+ld", -(gmtOffset_sec / 3600));
+    setenv("TZ", tz, 1);
+    tzset();
+}
+
+void configTzTime(const char *tz, const char *server1, const char *server2, const char *server3)
+{
+    setenv("TZ", tz, 1);
+    tzset();
+}
+
+// ----- heap -----
+// The free sizes are a nominal 8MB heap less what the host allocator has handed
+// out, so before/after deltas measure the allocations in between.
+
+#define NATIVE_HEAP_SIZE (8 * 1024 * 1024)
+
+void *heap_caps_malloc(size_t size, uint32_t caps)
+{
+    return malloc(size);
+}
+
+void *heap_caps_calloc(size_t n, size_t size, uint32_t caps)
+{
+    return calloc(n, size);
+}
+
+void heap_caps_free(void *ptr)
+{
+    free(ptr);
+}
+
+size_t heap_caps_get_free_size(uint32_t caps)
+{
+    size_t used = mallinfo2().uordblks;
+    return used < NATIVE_HEAP_SIZE ? NATIVE_HEAP_SIZE - used : 0;
+}
+
+size_t heap_caps_get_largest_free_block(uint32_t caps)
+{
+    return heap_caps_get_free_size(caps);
+}
@@ -0,0 +1,132 @@
+#ifndef NATIVE_ARDUINO_H
+#define NATIVE_ARDUINO_H
+
+//
+// Thin host shim of the Arduino-ESP32 core so the firmware can be compiled and
+// run on a Linux box. Only the pieces MarbleMadness actually uses are provided.
+// Time is simulated: millis() only advances when every task is blocked (see
+// freertos.cpp), so frames are reproducible run to run.
+//
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include <time.h>
+#include <string>
+
+#include "freertos.h"
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define ARDUINO_BOARD "native"
+#define F(s) (s)
+
+#ifndef constrain
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#endif
+
+// simulated clock
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void native_clock_advance(unsigned long ms); // let the other tasks run for ms of simulated time
+uint64_t native_micros();
+
+// seconds since the epoch that the simulated clock started at (see getLocalTime())
+extern time_t native_epoch;
+
+long map(long x, long in_min, long in_max, long out_min, long out_max);
+
+void randomSeed(unsigned long seed);
+long random(long howbig);
+long random(long howsmall, long howbig);
+uint32_t esp_random();
+
+class String
+{
+public:
+    String(const char *s = "") : str(s ? s : "") {}
+    String(const std::string &s) : str(s) {}
+    String(char c) : str(1, c) {}
+    String(int v) : str(std::to_string(v)) {}
+    String(unsigned int v) : str(std::to_string(v)) {}
+    String(long v) : str(std::to_string(v)) {}
+    String(unsigned long v) : str(std::to_string(v)) {}
+    String(float v) : str(std::to_string(v)) {}
+    String(double v) : str(std::to_string(v)) {}
+
+    const char *c_str() const { return str.c_str(); }
+    size_t length() const { return str.length(); }
+    bool equalsIgnoreCase(const String &s) const { return strcasecmp(str.c_str(), s.c_str()) == 0; }
+    bool operator==(const String &s) const { return str == s.str; }
+    String &operator+=(const String &s)
+    {
+        str += s.str;
+        return *this;
+    }
+    friend String operator+(const String &a, const String &b) { return String(a.str + b.str); }
+    friend String operator+(const char *a, const String &b) { return String(std::string(a) + b.str); }
+
+private:
+    std::string str;
+};
+
+class HardwareSerial
+{
+public:
+    void begin(unsigned long) {}
+    explicit operator bool() const { return true; }
+    size_t print(const String &s) { return fputs(s.c_str(), stdout); }
+    size_t print(const char *s) { return fputs(s, stdout); }
+    size_t print(char c) { return fputc(c, stdout); }
+    size_t print(long v) { return printf("%ld", v); }
+    size_t print(int v) { return printf("%d", v); }
+    size_t print(unsigned int v) { return printf("%u", v); }
+    size_t print(unsigned long v) { return printf("%lu", v); }
+    size_t print(double v) { return printf("%.2f", v); }
+    template <typename T>
+    size_t println(const T &v)
+    {
+        size_t n = print(v);
+        return n + print('\n');
+    }
+    size_t println() { return print('\n'); }
+    size_t println(const struct tm *timeinfo, const char *format);
+    size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+};
+extern HardwareSerial Serial;
+
+class EspClass
+{
+public:
+    const char *getChipModel() { return "native"; }
+    uint8_t getChipRevision() { return 0; }
+    uint8_t getChipCores() { return 2; }
+    uint32_t getCpuFreqMHz() { return 240; }
+    uint32_t getFlashChipSize() { return 16 * 1024 * 1024; }
+    uint32_t getFlashChipSpeed() { return 80000000; }
+    uint32_t getPsramSize() { return 8 * 1024 * 1024; }
+    uint32_t getFreePsram() { return 8 * 1024 * 1024; }
+};
+extern EspClass ESP;
+
+// esp32-hal-time (local time is native_epoch plus the simulated clock)
+bool getLocalTime(struct tm *info, uint32_t ms = 5000);
+void configTime(long gmtOffset_sec, int daylightOffset_sec, const char *server1, const char *server2 = nullptr, const char *server3 = nullptr);
+void configTzTime(const char *tz, const char *server1, const char *server2 = nullptr, const char *server3 = nullptr);
+
+// esp_heap_caps
+#define MALLOC_CAP_8BIT (1 << 2)
+#define MALLOC_CAP_SPIRAM (1 << 10)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+void *heap_caps_malloc(size_t size, uint32_t caps);
+void *heap_caps_calloc(size_t n, size_t size, uint32_t caps);
+void heap_caps_free(void *ptr);
+size_t heap_caps_get_free_size(uint32_t caps);
+size_t heap_caps_get_largest_free_block(uint32_t caps);
+
+#endif // NATIVE_ARDUINO_H
@@ -0,0 +1,173 @@
+#include <FastLED.h>
+
+// FastLED's default seed
+uint16_t rand16seed = 1337;
+
+CFastLED FastLED;
+void (*native_show_hook)(CFastLED &fastled, uint8_t scale) = nullptr;
+
+void CFastLED::show(uint8_t scale)
+{
+    if (native_show_hook)
+        native_show_hook(*this, scale);
+}
+
+void CFastLED::clear(bool writeData)
+{
+    for (int i = 0; i < m_count; i++)
+        fill_solid(m_controllers[i]->leds(), m_controllers[i]->size(), CRGB::Black);
+    if (writeData)
+        show(0);
+}
+
+// ----- colors -----
+
+CRGB &nblend(CRGB &existing, const CRGB &overlay, fract8 amountOfOverlay)
+{
+    if (amountOfOverlay == 0)
+        return existing;
+    if (amountOfOverlay == 255)
+    {
+        existing = overlay;
+        return existing;
+    }
+    existing.red = blend8(existing.red, overlay.red, amountOfOverlay);
+    existing.green = blend8(existing.green, overlay.green, amountOfOverlay);
+    existing.blue = blend8(existing.blue, overlay.blue, amountOfOverlay);
+    return existing;
+}
+
+CRGB blend(const CRGB &p1, const CRGB &p2, fract8 amountOfP2)
+{
+    CRGB nu(p1);
+    nblend(nu, p2, amountOfP2);
+    return nu;
+}
+
+void fill_solid(struct CRGB *leds, int numToFill, const struct CRGB &color)
+{
+    for (int i = 0; i < numToFill; i++)
+        leds[i] = color;
+}
+
+void fadeToBlackBy(CRGB *leds, uint16_t num_leds, uint8_t fadeBy)
+{
+    for (uint16_t i = 0; i < num_leds; i++)
+        leds[i].nscale8(255 - fadeBy);
+}
+
+// ----- palettes -----
+
+const TProgmemRGBPalette16 HeatColors_p = {
+    0x000000,
+    0x330000, 0x660000, 0x990000, 0xCC0000, 0xFF0000,
+    0xFF3300, 0xFF6600, 0xFF9900, 0xFFCC00, 0xFFFF00,
+    0xFFFF33, 0xFFFF66, 0xFFFF99, 0xFFFFCC, 0xFFFFFF};
+
+CRGB ColorFromPalette(const TProgmemRGBPalette16 &pal, uint8_t index, uint8_t brightness, TBlendType blendType)
+{
+    uint8_t hi4 = index >> 4;
+    uint8_t lo4 = index & 0x0F;
+
+    CRGB entry(pal[hi4]);
+    uint8_t red1 = entry.red;
+    uint8_t green1 = entry.green;
+    uint8_t blue1 = entry.blue;
+
+    // blend toward the next entry (wrapping around)
+    if (lo4 && blendType != NOBLEND)
+    {
+        entry = CRGB(pal[(hi4 + 1) & 0x0F]);
+        uint8_t f2 = lo4 << 4;
+        uint8_t f1 = 255 - f2;
+        red1 = scale8(red1, f1) + scale8(entry.red, f2);
+        green1 = scale8(green1, f1) + scale8(entry.green, f2);
+        blue1 = scale8(blue1, f1) + scale8(entry.blue, f2);
+    }
+
+    if (brightness != 255)
+    {
+        if (brightness)
+        {
+            brightness++; // adjust for rounding
+            red1 = scale8(red1, brightness);
+            green1 = scale8(green1, brightness);
+            blue1 = scale8(blue1, brightness);
+        }
+        else
+        {
+            red1 = green1 = blue1 = 0;
+        }
+    }
+    return CRGB(red1, green1, blue1);
+}
+
+// ----- noise -----
+// Gradient noise on a hashed lattice with the same scale as FastLED's inoise8()
+// (one lattice cell per 256 input units, output centered on 128). It isn't bit
+// exact with FastLED but looks the same.
+
+static uint8_t lattice_hash(uint16_t x, uint16_t y, uint16_t z)
+{
+    uint32_t h = x * 0x8DA6B343u ^ y * 0xD8163841u ^ z * 0xCB1AB31Fu;
+    h ^= h >> 15;
+    h *= 0x2C1B3C6Du;
+    h ^= h >> 12;
+    return h;
+}
+
+static float gradient(uint8_t hash, float x, float y, float z)
+{
+    // the 12 cube edge gradients (and 4 repeats), like Perlin's improved noise
+    switch (hash & 15)
+    {
+    case 0: return x + y;
+    case 1: return -x + y;
+    case 2: return x - y;
+    case 3: return -x - y;
+    case 4: return x + z;
+    case 5: return -x + z;
+    case 6: return x - z;
+    case 7: return -x - z;
+    case 8: return y + z;
+    case 9: return -y + z;
+    case 10: return y - z;
+    case 11: return -y - z;
+    case 12: return x + y;
+    case 13: return -y + z;
+    case 14: return -x + y;
+    default: return -y - z;
+    }
+}
+
+static float fade(float t)
+{
+    return t * t * t * (t * (t * 6 - 15) + 10);
+}
+
+static float lerp(float a, float b, float t)
+{
+    return a + t * (b - a);
+}
+
+uint8_t inoise8(uint16_t x, uint16_t y, uint16_t z)
+{
+    uint16_t X = x >> 8, Y = y >> 8, Z = z >> 8;
+    float fx = (x & 0xFF) / 256.0f, fy = (y & 0xFF) / 256.0f, fz = (z & 0xFF) / 256.0f;
+    float u = fade(fx), v = fade(fy), w = fade(fz);
+
+    float n = lerp(lerp(lerp(gradient(lattice_hash(X, Y, Z), fx, fy, fz), gradient(lattice_hash(X + 1, Y, Z), fx - 1, fy, fz), u),
+                        lerp(gradient(lattice_hash(X, Y + 1, Z), fx, fy - 1, fz), gradient(lattice_hash(X + 1, Y + 1, Z), fx - 1, fy - 1, fz), u), v),
+                   lerp(lerp(gradient(lattice_hash(X, Y, Z + 1), fx, fy, fz - 1), gradient(lattice_hash(X + 1, Y, Z + 1), fx - 1, fy, fz - 1), u),
+                        lerp(gradient(lattice_hash(X, Y + 1, Z + 1), fx, fy - 1, fz - 1), gradient(lattice_hash(X + 1, Y + 1, Z + 1), fx - 1, fy - 1, fz - 1), u), v),
+                   w);
+
+    // n is roughly -1..1
+    int value = 128 + (int)(n * 128);
+    return value < 0 ? 0 : value > 255 ? 255 : value;
+}
+
+uint8_t inoise8(uint16_t x, uint16_t y)
+{
+    return inoise8(x, y, 0);
+}
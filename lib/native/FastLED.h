@@ -0,0 +1,473 @@
+#ifndef NATIVE_FASTLED_H
+#define NATIVE_FASTLED_H
+
+//
+// Thin host shim of the parts of FastLED that MarbleMadness uses: CRGB and its
+// named colors, the lib8tion math helpers, palettes, noise, the EVERY_N_*
+// timing macros and a CFastLED object whose show() hands the frame to the host
+// driver through native_show_hook. The 8-bit math follows FastLED's portable C
+// implementations (FASTLED_SCALE8_FIXED/FASTLED_BLEND_FIXED) so pixel results
+// match the device; inoise8() is a plain Perlin implementation and only
+// approximates FastLED's.
+//
+#include <Arduino.h>
+
+typedef uint8_t fract8;
+typedef uint16_t fract16;
+typedef int16_t saccum78;
+typedef uint16_t accum88;
+typedef int32_t saccum1516;
+
+#define LIB8STATIC static inline
+
+LIB8STATIC uint8_t scale8(uint8_t i, fract8 scale) { return (uint8_t)(((uint16_t)i * (1 + (uint16_t)scale)) >> 8); }
+LIB8STATIC uint8_t scale8_video(uint8_t i, fract8 scale) { return (((int)i * (int)scale) >> 8) + ((i && scale) ? 1 : 0); }
+LIB8STATIC uint16_t scale16(uint16_t i, fract16 scale) { return (uint16_t)(((uint32_t)i * (1 + (uint32_t)scale)) >> 16); }
+LIB8STATIC uint8_t qadd8(uint8_t i, uint8_t j)
+{
+    unsigned int t = i + j;
+    return t > 255 ? 255 : t;
+}
+LIB8STATIC uint8_t qsub8(uint8_t i, uint8_t j)
+{
+    int t = i - j;
+    return t < 0 ? 0 : t;
+}
+LIB8STATIC uint8_t dim8_raw(uint8_t x) { return scale8(x, x); }
+LIB8STATIC uint8_t blend8(uint8_t a, uint8_t b, uint8_t amountOfB)
+{
+    uint16_t partial = (a << 8) | b;
+    partial += (b * amountOfB);
+    partial -= (a * amountOfB);
+    return partial >> 8;
+}
+
+// random numbers (FastLED's 16 bit LCG)
+extern uint16_t rand16seed;
+LIB8STATIC uint8_t random8()
+{
+    rand16seed = (rand16seed * 2053) + 13849;
+    return (uint8_t)(((uint8_t)(rand16seed & 0xFF)) + ((uint8_t)(rand16seed >> 8)));
+}
+LIB8STATIC uint16_t random16()
+{
+    rand16seed = (rand16seed * 2053) + 13849;
+    return rand16seed;
+}
+LIB8STATIC uint8_t random8(uint8_t lim) { return (uint8_t)(((uint16_t)random8() * lim) >> 8); }
+LIB8STATIC uint8_t random8(uint8_t min, uint8_t lim) { return random8(lim - min) + min; }
+LIB8STATIC uint16_t random16(uint16_t lim) { return (uint16_t)(((uint32_t)random16() * lim) >> 16); }
+LIB8STATIC uint16_t random16(uint16_t min, uint16_t lim) { return random16(lim - min) + min; }
+LIB8STATIC void random16_set_seed(uint16_t seed) { rand16seed = seed; }
+LIB8STATIC void random16_add_entropy(uint16_t entropy) { rand16seed += entropy; }
+
+// trig
+LIB8STATIC int16_t sin16(uint16_t theta)
+{
+    static const uint16_t base[] = {0, 6393, 12539, 18204, 23170, 27245, 30273, 32137};
+    static const uint8_t slope[] = {49, 48, 44, 38, 31, 23, 14, 4};
+    uint16_t offset = (theta & 0x3FFF) >> 3; // 0..2047
+    if (theta & 0x4000)
+        offset = 2047 - offset;
+    uint8_t section = offset / 256; // 0..7
+    uint16_t b = base[section];
+    uint8_t m = slope[section];
+    uint8_t secoffset8 = (uint8_t)(offset) / 2;
+    uint16_t mx = m * secoffset8;
+    int16_t y = mx + b;
+    if (theta & 0x8000)
+        y = -y;
+    return y;
+}
+LIB8STATIC int16_t cos16(uint16_t theta) { return sin16(theta + 16384); }
+
+uint8_t inoise8(uint16_t x, uint16_t y);
+uint8_t inoise8(uint16_t x, uint16_t y, uint16_t z);
+
+typedef enum
+{
+    HTMLColorCode_placeholder = -1
+} HTMLColorCodePlaceholder;
+
+struct CRGB
+{
+    union
+    {
+        struct
+        {
+            union
+            {
+                uint8_t r;
+                uint8_t red;
+            };
+            union
+            {
+                uint8_t g;
+                uint8_t green;
+            };
+            union
+            {
+                uint8_t b;
+                uint8_t blue;
+            };
+        };
+        uint8_t raw[3];
+    };
+
+    typedef enum
+    {
+        AliceBlue = 0xF0F8FF,
+        Amethyst = 0x9966CC,
+        AntiqueWhite = 0xFAEBD7,
+        Aqua = 0x00FFFF,
+        Aquamarine = 0x7FFFD4,
+        Azure = 0xF0FFFF,
+        Beige = 0xF5F5DC,
+        Bisque = 0xFFE4C4,
+        Black = 0x000000,
+        BlanchedAlmond = 0xFFEBCD,
+        Blue = 0x0000FF,
+        BlueViolet = 0x8A2BE2,
+        Brown = 0xA52A2A,
+        BurlyWood = 0xDEB887,
+        CadetBlue = 0x5F9EA0,
+        Chartreuse = 0x7FFF00,
+        Chocolate = 0xD2691E,
+        Coral = 0xFF7F50,
+        CornflowerBlue = 0x6495ED,
+        Cornsilk = 0xFFF8DC,
+        Crimson = 0xDC143C,
+        Cyan = 0x00FFFF,
+        DarkBlue = 0x00008B,
+        DarkCyan = 0x008B8B,
+        DarkGoldenrod = 0xB8860B,
+        DarkGray = 0xA9A9A9,
+        DarkGrey = 0xA9A9A9,
+        DarkGreen = 0x006400,
+        DarkKhaki = 0xBDB76B,
+        DarkMagenta = 0x8B008B,
+        DarkOliveGreen = 0x556B2F,
+        DarkOrange = 0xFF8C00,
+        DarkOrchid = 0x9932CC,
+        DarkRed = 0x8B0000,
+        DarkSalmon = 0xE9967A,
+        DarkSeaGreen = 0x8FBC8F,
+        DarkSlateBlue = 0x483D8B,
+        DarkSlateGray = 0x2F4F4F,
+        DarkSlateGrey = 0x2F4F4F,
+        DarkTurquoise = 0x00CED1,
+        DarkViolet = 0x9400D3,
+        DeepPink = 0xFF1493,
+        DeepSkyBlue = 0x00BFFF,
+        DimGray = 0x696969,
+        DimGrey = 0x696969,
+        DodgerBlue = 0x1E90FF,
+        FireBrick = 0xB22222,
+        FloralWhite = 0xFFFAF0,
+        ForestGreen = 0x228B22,
+        Fuchsia = 0xFF00FF,
+        Gainsboro = 0xDCDCDC,
+        GhostWhite = 0xF8F8FF,
+        Gold = 0xFFD700,
+        Goldenrod = 0xDAA520,
+        Gray = 0x808080,
+        Grey = 0x808080,
+        Green = 0x008000,
+        GreenYellow = 0xADFF2F,
+        Honeydew = 0xF0FFF0,
+        HotPink = 0xFF69B4,
+        IndianRed = 0xCD5C5C,
+        Indigo = 0x4B0082,
+        Ivory = 0xFFFFF0,
+        Khaki = 0xF0E68C,
+        Lavender = 0xE6E6FA,
+        LavenderBlush = 0xFFF0F5,
+        LawnGreen = 0x7CFC00,
+        LemonChiffon = 0xFFFACD,
+        LightBlue = 0xADD8E6,
+        LightCoral = 0xF08080,
+        LightCyan = 0xE0FFFF,
+        LightGoldenrodYellow = 0xFAFAD2,
+        LightGreen = 0x90EE90,
+        LightGrey = 0xD3D3D3,
+        LightPink = 0xFFB6C1,
+        LightSalmon = 0xFFA07A,
+        LightSeaGreen = 0x20B2AA,
+        LightSkyBlue = 0x87CEFA,
+        LightSlateGray = 0x778899,
+        LightSlateGrey = 0x778899,
+        LightSteelBlue = 0xB0C4DE,
+        LightYellow = 0xFFFFE0,
+        Lime = 0x00FF00,
+        LimeGreen = 0x32CD32,
+        Linen = 0xFAF0E6,
+        Magenta = 0xFF00FF,
+        Maroon = 0x800000,
+        MediumAquamarine = 0x66CDAA,
+        MediumBlue = 0x0000CD,
+        MediumOrchid = 0xBA55D3,
+        MediumPurple = 0x9370DB,
+        MediumSeaGreen = 0x3CB371,
+        MediumSlateBlue = 0x7B68EE,
+        MediumSpringGreen = 0x00FA9A,
+        MediumTurquoise = 0x48D1CC,
+        MediumVioletRed = 0xC71585,
+        MidnightBlue = 0x191970,
+        MintCream = 0xF5FFFA,
+        MistyRose = 0xFFE4E1,
+        Moccasin = 0xFFE4B5,
+        NavajoWhite = 0xFFDEAD,
+        Navy = 0x000080,
+        OldLace = 0xFDF5E6,
+        Olive = 0x808000,
+        OliveDrab = 0x6B8E23,
+        Orange = 0xFFA500,
+        OrangeRed = 0xFF4500,
+        Orchid = 0xDA70D6,
+        PaleGoldenrod = 0xEEE8AA,
+        PaleGreen = 0x98FB98,
+        PaleTurquoise = 0xAFEEEE,
+        PaleVioletRed = 0xDB7093,
+        PapayaWhip = 0xFFEFD5,
+        PeachPuff = 0xFFDAB9,
+        Peru = 0xCD853F,
+        Pink = 0xFFC0CB,
+        Plaid = 0xCC5533,
+        Plum = 0xDDA0DD,
+        PowderBlue = 0xB0E0E6,
+        Purple = 0x800080,
+        Red = 0xFF0000,
+        RosyBrown = 0xBC8F8F,
+        RoyalBlue = 0x4169E1,
+        SaddleBrown = 0x8B4513,
+        Salmon = 0xFA8072,
+        SandyBrown = 0xF4A460,
+        SeaGreen = 0x2E8B57,
+        Seashell = 0xFFF5EE,
+        Sienna = 0xA0522D,
+        Silver = 0xC0C0C0,
+        SkyBlue = 0x87CEEB,
+        SlateBlue = 0x6A5ACD,
+        SlateGray = 0x708090,
+        SlateGrey = 0x708090,
+        Snow = 0xFFFAFA,
+        SpringGreen = 0x00FF7F,
+        SteelBlue = 0x4682B4,
+        Tan = 0xD2B48C,
+        Teal = 0x008080,
+        Thistle = 0xD8BFD8,
+        Tomato = 0xFF6347,
+        Turquoise = 0x40E0D0,
+        Violet = 0xEE82EE,
+        Wheat = 0xF5DEB3,
+        White = 0xFFFFFF,
+        WhiteSmoke = 0xF5F5F5,
+        Yellow = 0xFFFF00,
+        YellowGreen = 0x9ACD32,
+    } HTMLColorCode;
+
+    CRGB() = default;
+    constexpr CRGB(uint8_t ir, uint8_t ig, uint8_t ib) : r(ir), g(ig), b(ib) {}
+    constexpr CRGB(uint32_t colorcode) : r((colorcode >> 16) & 0xFF), g((colorcode >> 8) & 0xFF), b((colorcode >> 0) & 0xFF) {}
+    constexpr CRGB(HTMLColorCode colorcode) : r((colorcode >> 16) & 0xFF), g((colorcode >> 8) & 0xFF), b((colorcode >> 0) & 0xFF) {}
+
+    inline uint8_t &operator[](uint8_t x) { return raw[x]; }
+    inline const uint8_t &operator[](uint8_t x) const { return raw[x]; }
+
+    inline CRGB &setRGB(uint8_t nr, uint8_t ng, uint8_t nb)
+    {
+        r = nr;
+        g = ng;
+        b = nb;
+        return *this;
+    }
+    inline CRGB &nscale8(uint8_t scaledown)
+    {
+        r = scale8(r, scaledown);
+        g = scale8(g, scaledown);
+        b = scale8(b, scaledown);
+        return *this;
+    }
+    inline CRGB &fadeToBlackBy(uint8_t fadefactor) { return nscale8(255 - fadefactor); }
+    inline CRGB &operator+=(const CRGB &rhs)
+    {
+        r = qadd8(r, rhs.r);
+        g = qadd8(g, rhs.g);
+        b = qadd8(b, rhs.b);
+        return *this;
+    }
+    inline explicit operator bool() const { return r || g || b; }
+};
+
+inline bool operator==(const CRGB &lhs, const CRGB &rhs) { return (lhs.r == rhs.r) && (lhs.g == rhs.g) && (lhs.b == rhs.b); }
+inline bool operator!=(const CRGB &lhs, const CRGB &rhs) { return !(lhs == rhs); }
+
+CRGB &nblend(CRGB &existing, const CRGB &overlay, fract8 amountOfOverlay);
+CRGB blend(const CRGB &p1, const CRGB &p2, fract8 amountOfP2);
+void fill_solid(struct CRGB *leds, int numToFill, const struct CRGB &color);
+void fadeToBlackBy(CRGB *leds, uint16_t num_leds, uint8_t fadeBy);
+
+// palettes
+typedef uint32_t TProgmemRGBPalette16[16];
+typedef enum
+{
+    NOBLEND = 0,
+    LINEARBLEND = 1
+} TBlendType;
+extern const TProgmemRGBPalette16 HeatColors_p;
+CRGB ColorFromPalette(const TProgmemRGBPalette16 &pal, uint8_t index, uint8_t brightness = 255, TBlendType blendType = LINEARBLEND);
+
+// color correction and dithering
+typedef enum
+{
+    TypicalSMD5050 = 0xFFB0F0,
+    TypicalLEDStrip = 0xFFB0F0,
+    TypicalPixelString = 0xFFE08C,
+    UncorrectedColor = 0xFFFFFF
+} LEDColorCorrection;
+#define BINARY_DITHER 0x01
+#define DISABLE_DITHER 0x00
+
+// chipsets and color orders only need to exist as template arguments
+enum ESPIChipsets
+{
+    WS2812,
+    WS2812B,
+    WS2811,
+    SK6812
+};
+enum EOrder
+{
+    RGB = 0012,
+    RBG = 0021,
+    GRB = 0102,
+    GBR = 0120,
+    BRG = 0201,
+    BGR = 0210
+};
+
+class CLEDController
+{
+public:
+    CLEDController(CRGB *data, int nLeds) : m_data(data), m_nLeds(nLeds) {}
+    CLEDController &setCorrection(CRGB correction)
+    {
+        m_correction = correction;
+        return *this;
+    }
+    CLEDController &setCorrection(LEDColorCorrection correction) { return setCorrection(CRGB((uint32_t)correction)); }
+    CLEDController &setLeds(CRGB *data, int nLeds)
+    {
+        m_data = data;
+        m_nLeds = nLeds;
+        return *this;
+    }
+    CRGB getCorrection() const { return m_correction; }
+    CRGB *leds() { return m_data; }
+    int size() const { return m_nLeds; }
+
+private:
+    CRGB *m_data;
+    int m_nLeds;
+    CRGB m_correction = CRGB(0xFFFFFF);
+};
+
+#define NATIVE_MAX_CONTROLLERS 8
+
+class CFastLED
+{
+public:
+    template <ESPIChipsets CHIPSET, uint8_t DATA_PIN, EOrder RGB_ORDER>
+    CLEDController &addLeds(CRGB *data, int nLeds)
+    {
+        return *(m_controllers[m_count++] = new CLEDController(data, nLeds));
+    }
+    void setBrightness(uint8_t scale) { m_scale = scale; }
+    uint8_t getBrightness() const { return m_scale; }
+    void setCorrection(const CRGB &correction)
+    {
+        for (int i = 0; i < m_count; i++)
+            m_controllers[i]->setCorrection(correction);
+    }
+    void setDither(uint8_t ditherMode) { m_dither = ditherMode; }
+    void show() { show(m_scale); }
+    void show(uint8_t scale);
+    void clear(bool writeData = false);
+    int count() const { return m_count; }
+    CLEDController &operator[](int x) { return *m_controllers[x]; }
+
+private:
+    CLEDController *m_controllers[NATIVE_MAX_CONTROLLERS] = {};
+    int m_count = 0;
+    uint8_t m_scale = 255;
+    uint8_t m_dither = BINARY_DITHER;
+};
+extern CFastLED FastLED;
+
+// called at the end of every FastLED.show() so the host driver can capture the frame
+extern void (*native_show_hook)(CFastLED &fastled, uint8_t scale);
+
+// timing macros
+class CEveryNMillis
+{
+public:
+    CEveryNMillis(uint32_t period) : m_period(period), m_prevTrigger(millis()) {}
+    void setPeriod(uint32_t period) { m_period = period; }
+    uint32_t getPeriod() const { return m_period; }
+    bool ready()
+    {
+        uint32_t now = millis();
+        if (now - m_prevTrigger >= m_period)
+        {
+            m_prevTrigger = now;
+            return true;
+        }
+        return false;
+    }
+    void reset() { m_prevTrigger = millis(); }
+    operator bool() { return ready(); }
+
+private:
+    uint32_t m_period;
+    uint32_t m_prevTrigger;
+};
+
+class CEveryNSeconds
+{
+public:
+    CEveryNSeconds(uint16_t period) : m_period(period), m_prevTrigger(seconds16()) {}
+    void setPeriod(uint16_t period) { m_period = period; }
+    bool ready()
+    {
+        uint16_t now = seconds16();
+        if ((uint16_t)(now - m_prevTrigger) >= m_period)
+        {
+            m_prevTrigger = now;
+            return true;
+        }
+        return false;
+    }
+    operator bool() { return ready(); }
+
+private:
+    static uint16_t seconds16() { return (uint16_t)(millis() / 1000); }
+    uint16_t m_period;
+    uint16_t m_prevTrigger;
+};
+
+#define CONCAT_HELPER(x, y) x##y
+#define CONCAT_MACRO(x, y) CONCAT_HELPER(x, y)
+#define INSTANCE_NAME CONCAT_MACRO(__every_n_, __COUNTER__)
+
+#define EVERY_N_MILLIS_I(NAME, N) \
+    static CEveryNMillis NAME(N); \
+    if (NAME)
+#define EVERY_N_MILLIS(N) EVERY_N_MILLIS_I(INSTANCE_NAME, N)
+#define EVERY_N_MILLISECONDS(N) EVERY_N_MILLIS(N)
+#define EVERY_N_MILLISECONDS_I(NAME, N) EVERY_N_MILLIS_I(NAME, N)
+#define EVERY_N_SECONDS_I(NAME, N) \
+    static CEveryNSeconds NAME(N); \
+    if (NAME)
+#define EVERY_N_SECONDS(N) EVERY_N_SECONDS_I(INSTANCE_NAME, N)
+
+#endif // NATIVE_FASTLED_H
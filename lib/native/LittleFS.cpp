@@ -0,0 +1,3 @@
+#include "LittleFS.h"
+
+fs::LittleFSFS LittleFS;
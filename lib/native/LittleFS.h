@@ -0,0 +1,76 @@
+#ifndef NATIVE_LITTLEFS_H
+#define NATIVE_LITTLEFS_H
+
+//
+// In-memory stand in for the ESP32 LittleFS library, just enough for reading and
+// writing whole files. Nothing is persisted between host runs.
+//
+#include <Arduino.h>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace fs
+{
+    class File
+    {
+    public:
+        File() {}
+        File(std::vector<uint8_t> *data, bool write) : m_data(data), m_write(write) {}
+
+        operator bool() const { return m_data != nullptr; }
+        size_t size() const { return m_data ? m_data->size() : 0; }
+        size_t read(uint8_t *buf, size_t size)
+        {
+            if (!m_data || m_write)
+                return 0;
+            size_t n = std::min(size, m_data->size() - m_position);
+            memcpy(buf, m_data->data() + m_position, n);
+            m_position += n;
+            return n;
+        }
+        size_t write(const uint8_t *buf, size_t size)
+        {
+            if (!m_data || !m_write)
+                return 0;
+            m_data->insert(m_data->end(), buf, buf + size);
+            return size;
+        }
+        void close() { m_data = nullptr; }
+
+    private:
+        std::vector<uint8_t> *m_data = nullptr;
+        bool m_write = false;
+        size_t m_position = 0;
+    };
+
+    class LittleFSFS
+    {
+    public:
+        bool begin(bool formatOnFail = false) { return true; }
+        void end() {}
+        bool exists(const char *path) { return m_files.count(path) > 0; }
+        bool remove(const char *path) { return m_files.erase(path) > 0; }
+        File open(const char *path, const char *mode = "r")
+        {
+            if (mode[0] == 'w')
+            {
+                std::vector<uint8_t> &data = m_files[path];
+                data.clear();
+                return File(&data, true);
+            }
+            auto it = m_files.find(path);
+            return it == m_files.end() ? File() : File(&it->second, false);
+        }
+
+    private:
+        std::map<std::string, std::vector<uint8_t>> m_files;
+    };
+}
+
+using fs::File;
+
+extern fs::LittleFSFS LittleFS;
+
+#endif // NATIVE_LITTLEFS_H
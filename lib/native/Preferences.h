@@ -0,0 +1,66 @@
+#ifndef NATIVE_PREFERENCES_H
+#define NATIVE_PREFERENCES_H
+
+//
+// In-memory stand in for the ESP32 NVS backed Preferences library. Nothing is
+// persisted between host runs.
+//
+#include <Arduino.h>
+#include <map>
+#include <vector>
+
+class Preferences
+{
+public:
+    bool begin(const char *name, bool readOnly = false) { return true; }
+    void end() {}
+    bool clear()
+    {
+        m_values.clear();
+        return true;
+    }
+    bool remove(const char *key) { return m_values.erase(key) > 0; }
+    bool isKey(const char *key) { return m_values.count(key) > 0; }
+
+    size_t putInt(const char *key, int32_t value) { return putBytes(key, &value, sizeof(value)); }
+    size_t putUInt(const char *key, uint32_t value) { return putBytes(key, &value, sizeof(value)); }
+    size_t putString(const char *key, const String &value) { return putBytes(key, value.c_str(), value.length() + 1); }
+    size_t putBytes(const char *key, const void *value, size_t len)
+    {
+        m_values[key].assign((const uint8_t *)value, (const uint8_t *)value + len);
+        return len;
+    }
+
+    int32_t getInt(const char *key, int32_t defaultValue = 0) { return get(key, defaultValue); }
+    uint32_t getUInt(const char *key, uint32_t defaultValue = 0) { return get(key, defaultValue); }
+    String getString(const char *key, const String &defaultValue = String())
+    {
+        auto it = m_values.find(key);
+        return it == m_values.end() ? defaultValue : String((const char *)it->second.data());
+    }
+    size_t getBytesLength(const char *key)
+    {
+        auto it = m_values.find(key);
+        return it == m_values.end() ? 0 : it->second.size();
+    }
+    size_t getBytes(const char *key, void *buf, size_t maxLen)
+    {
+        auto it = m_values.find(key);
+        if (it == m_values.end() || it->second.size() > maxLen)
+            return 0;
+        memcpy(buf, it->second.data(), it->second.size());
+        return it->second.size();
+    }
+
+private:
+    template <typename T>
+    T get(const char *key, T defaultValue)
+    {
+        T value = defaultValue;
+        getBytes(key, &value, sizeof(value));
+        return value;
+    }
+    std::map<std::string, std::vector<uint8_t>> m_values;
+};
+
+#endif // NATIVE_PREFERENCES_H
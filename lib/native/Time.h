@@ -0,0 +1,8 @@
+#ifndef NATIVE_TIME_H
+#define NATIVE_TIME_H
+
+// the device build pulls in <Time.h> for struct tm; the C library already provides it on the host
+// (include_next so case insensitive file systems don't find this file again)
+#include_next <time.h>
+
+#endif // NATIVE_TIME_H
@@ -0,0 +1,394 @@
+#include <Arduino.h>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+//
+// A lockstep scheduler: every task is a std::thread but only one of them runs at a
+// time. A task keeps running until it blocks (vTaskDelay(), an empty queue, a taken
+// semaphore) and then hands over to the next task that can run, round robin. When
+// nothing can run the simulated clock jumps to the next timeout. There is no
+// preemption, so for the same inputs every run interleaves the tasks the same way
+// and renders the same frames.
+//
+// The thread that calls into the scheduler first (main()) becomes the loop task.
+//
+
+#define NEVER UINT64_MAX
+
+struct native_task
+{
+    std::string name;
+    TaskFunction_t function;
+    void *parameters;
+    uint32_t stackDepth;
+    std::condition_variable wake;
+    bool ready;        // can run
+    uint64_t wakeAt;   // simulated micros when a blocked task times out
+    const void *waitingOn; // the queue or semaphore a blocked task is waiting for
+    bool deleted;
+    bool finished;
+};
+
+struct native_semaphore
+{
+    UBaseType_t count;
+    UBaseType_t max;
+};
+
+struct native_queue
+{
+    UBaseType_t length;
+    UBaseType_t itemSize;
+    std::deque<std::vector<uint8_t>> items;
+};
+
+// thrown inside a task that has been deleted to unwind its thread
+struct native_task_deleted
+{
+};
+
+// never destroyed so tasks still blocked when the program exits are left alone
+static std::mutex &lock = *new std::mutex;
+static std::vector<native_task *> &tasks = *new std::vector<native_task *>;
+static native_task *current = nullptr;
+static thread_local native_task *self = nullptr;
+static uint64_t now = 0; // simulated micros
+
+static native_task *new_task(const char *name, TaskFunction_t function, void *parameters, uint32_t stackDepth)
+{
+    native_task *task = new native_task;
+    task->name = name;
+    task->function = function;
+    task->parameters = parameters;
+    task->stackDepth = stackDepth;
+    task->ready = true;
+    task->wakeAt = NEVER;
+    task->waitingOn = nullptr;
+    task->deleted = false;
+    task->finished = false;
+    tasks.push_back(task);
+    return task;
+}
+
+// the calling thread's task (adopts the main thread as the loop task the first time)
+static native_task *me()
+{
+    if (!self)
+    {
+        self = new_task("loopTask", nullptr, nullptr, 8192);
+        current = self;
+    }
+    return self;
+}
+
+// pick the next task to run after task (which may be blocked), advancing the clock if need be
+static native_task *next_task(native_task *task)
+{
+    size_t start = 0;
+    while (tasks[start] != task)
+        start++;
+
+    while (true)
+    {
+        for (size_t i = 1; i <= tasks.size(); i++)
+        {
+            native_task *next = tasks[(start + i) % tasks.size()];
+            if (next->ready && !next->finished)
+                return next;
+        }
+
+        // nothing can run, skip ahead to the first timeout
+        uint64_t first = NEVER;
+        for (native_task *t : tasks)
+        {
+            if (!t->finished && t->wakeAt < first)
+                first = t->wakeAt;
+        }
+        if (first == NEVER)
+        {
+            fprintf(stderr, "native: deadlock, every task is blocked forever\n");
+            abort();
+        }
+
+        if (first > now)
+            now = first;
+        for (native_task *t : tasks)
+        {
+            if (!t->finished && t->wakeAt <= now)
+            {
+                t->ready = true;
+                t->wakeAt = NEVER;
+                t->waitingOn = nullptr;
+            }
+        }
+    }
+}
+
+// let the next task run and wait until it is our turn again
+static void switch_tasks(std::unique_lock<std::mutex> &held)
+{
+    native_task *task = me();
+    native_task *next = next_task(task);
+    if (next != task)
+    {
+        current = next;
+        next->wake.notify_one();
+        task->wake.wait(held, [task]
+                        { return current == task; });
+    }
+    if (task->deleted)
+        throw native_task_deleted();
+}
+
+// block the calling task until woken by waitingOn or the timeout (in ticks)
+static void block(std::unique_lock<std::mutex> &held, const void *waitingOn, TickType_t ticks)
+{
+    native_task *task = me();
+    task->ready = false;
+    task->waitingOn = waitingOn;
+    task->wakeAt = ticks == portMAX_DELAY ? NEVER : now + (uint64_t)ticks * 1000;
+    switch_tasks(held);
+}
+
+// make every task waiting on object runnable again (they recheck what they were waiting for)
+static void wake_waiters(const void *object)
+{
+    for (native_task *t : tasks)
+    {
+        if (t->waitingOn == object)
+        {
+            t->ready = true;
+            t->wakeAt = NEVER;
+            t->waitingOn = nullptr;
+        }
+    }
+}
+
+static void task_entry(native_task *task)
+{
+    self = task;
+    {
+        std::unique_lock<std::mutex> held(lock);
+        task->wake.wait(held, [task]
+                        { return current == task; });
+    }
+
+    try
+    {
+        if (!task->deleted)
+            task->function(task->parameters);
+    }
+    catch (native_task_deleted &)
+    {
+    }
+
+    // the task is gone, hand over without waiting
+    std::unique_lock<std::mutex> held(lock);
+    task->ready = false;
+    native_task *next = next_task(task);
+    task->finished = true;
+    current = next;
+    next->wake.notify_one();
+}
+
+// ----- clock -----
+
+uint64_t native_micros()
+{
+    std::lock_guard<std::mutex> held(lock);
+    return now;
+}
+
+void native_clock_advance(unsigned long ms)
+{
+    vTaskDelay(ms);
+}
+
+// ----- tasks -----
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char *name, uint32_t stackDepth, void *parameters, UBaseType_t priority, TaskHandle_t *createdTask, BaseType_t coreID)
+{
+    std::lock_guard<std::mutex> held(lock);
+    me();
+
+    // the new task runs the next time the caller blocks
+    native_task *task = new_task(name, function, parameters, stackDepth);
+    std::thread(task_entry, task).detach();
+    if (createdTask)
+        *createdTask = task;
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+    std::unique_lock<std::mutex> held(lock);
+    if (!task || task == me())
+    {
+        me()->deleted = true;
+        throw native_task_deleted();
+    }
+
+    // run it one last time so its thread unwinds
+    task->deleted = true;
+    task->ready = true;
+    task->waitingOn = nullptr;
+    task->wakeAt = NEVER;
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    std::unique_lock<std::mutex> held(lock);
+    if (ticks)
+        block(held, nullptr, ticks);
+    else
+        switch_tasks(held);
+}
+
+void vTaskDelayUntil(TickType_t *previousWakeTime, TickType_t timeIncrement)
+{
+    std::unique_lock<std::mutex> held(lock);
+    *previousWakeTime += timeIncrement;
+    TickType_t ticks = now / 1000;
+    if ((int32_t)(*previousWakeTime - ticks) > 0)
+        block(held, nullptr, *previousWakeTime - ticks);
+    else
+        switch_tasks(held);
+}
+
+TickType_t xTaskGetTickCount()
+{
+    std::lock_guard<std::mutex> held(lock);
+    return now / 1000;
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task)
+{
+    // host threads have large stacks, report the stack the task asked for as unused
+    std::lock_guard<std::mutex> held(lock);
+    return task ? task->stackDepth : me()->stackDepth;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle()
+{
+    std::lock_guard<std::mutex> held(lock);
+    return me();
+}
+
+void taskYIELD()
+{
+    vTaskDelay(0);
+}
+
+// ----- semaphores -----
+
+static SemaphoreHandle_t new_semaphore(UBaseType_t count, UBaseType_t max)
+{
+    native_semaphore *sem = new native_semaphore;
+    sem->count = count;
+    sem->max = max;
+    return sem;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex()
+{
+    return new_semaphore(1, 1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary()
+{
+    return new_semaphore(0, 1);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks)
+{
+    std::unique_lock<std::mutex> held(lock);
+    uint64_t deadline = ticks == portMAX_DELAY ? NEVER : now + (uint64_t)ticks * 1000;
+    while (!sem->count)
+    {
+        if (now >= deadline)
+            return pdFALSE;
+        block(held, sem, deadline == NEVER ? portMAX_DELAY : (deadline - now + 999) / 1000);
+    }
+    sem->count--;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem)
+{
+    std::lock_guard<std::mutex> held(lock);
+    if (sem->count >= sem->max)
+        return pdFALSE;
+    sem->count++;
+    wake_waiters(sem);
+    return pdTRUE;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t sem)
+{
+    delete sem;
+}
+
+// ----- queues -----
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize)
+{
+    native_queue *queue = new native_queue;
+    queue->length = length;
+    queue->itemSize = itemSize;
+    return queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks)
+{
+    std::unique_lock<std::mutex> held(lock);
+    uint64_t deadline = ticks == portMAX_DELAY ? NEVER : now + (uint64_t)ticks * 1000;
+    while (queue->items.size() >= queue->length)
+    {
+        if (now >= deadline)
+            return pdFALSE;
+        block(held, queue, deadline == NEVER ? portMAX_DELAY : (deadline - now + 999) / 1000);
+    }
+    queue->items.emplace_back((const uint8_t *)item, (const uint8_t *)item + queue->itemSize);
+    wake_waiters(queue);
+    return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks)
+{
+    std::unique_lock<std::mutex> held(lock);
+    uint64_t deadline = ticks == portMAX_DELAY ? NEVER : now + (uint64_t)ticks * 1000;
+    while (queue->items.empty())
+    {
+        if (now >= deadline)
+            return pdFALSE;
+        block(held, queue, deadline == NEVER ? portMAX_DELAY : (deadline - now + 999) / 1000);
+    }
+    memcpy(item, queue->items.front().data(), queue->itemSize);
+    queue->items.pop_front();
+    wake_waiters(queue);
+    return pdTRUE;
+}
+
+BaseType_t xQueueOverwrite(QueueHandle_t queue, const void *item)
+{
+    std::lock_guard<std::mutex> held(lock);
+    queue->items.clear();
+    queue->items.emplace_back((const uint8_t *)item, (const uint8_t *)item + queue->itemSize);
+    wake_waiters(queue);
+    return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue)
+{
+    std::lock_guard<std::mutex> held(lock);
+    return queue->items.size();
+}
+
+void vQueueDelete(QueueHandle_t queue)
+{
+    delete queue;
+}
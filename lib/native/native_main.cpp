@@ -0,0 +1,165 @@
+#include "main.h"
+#include "settings.h"
+#include "modes.h"
+#include "render.h"
+#include "benchmark.h"
+#include <sys/stat.h>
+#include <unistd.h>
+
+//
+// Host driver for the native environment: runs setup() and then loop() against the
+// simulated clock and writes every frame that FastLED.show() sends out as a PPM
+// image, e.g.
+//
+//   .pio/build/native/program --mode pachinko --seconds 20 --out frames
+//   ffmpeg -framerate 60 -i frames/frame%05d.ppm pachinko.gif
+//
+// Each image is the panel as wired up (after brightness and color correction) with
+// every LED drawn as a square of --size pixels.
+//
+// --benchmark N prints the frame times of every mode instead (see benchmark.h).
+//
+
+void setup();
+void loop();
+
+static const char *outputDir = "frames";
+static int pixelSize = 8;
+static uint32_t framesWritten = 0;
+
+static void write_frame(CFastLED &fastled, uint8_t scale)
+{
+    if (!fastled.count())
+        return;
+
+    // the strips are consecutive slices of one physical frame
+    const CRGB *physical = fastled[0].leds();
+
+    char path[256];
+    snprintf(path, sizeof(path), "%s/frame%05u.ppm", outputDir, framesWritten++);
+    FILE *file = fopen(path, "wb");
+    if (!file)
+    {
+        perror(path);
+        exit(1);
+    }
+
+    int width = NUM_COLS * pixelSize;
+    int height = NUM_ROWS * pixelSize;
+    fprintf(file, "P6\n%d %d\n255\n", width, height);
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            CRGB pixel = physical[XYLookup.index[(y / pixelSize) * NUM_COLS + x / pixelSize]];
+            pixel.nscale8(scale);
+            fwrite(pixel.raw, 1, 3, file);
+        }
+    }
+    fclose(file);
+}
+
+static void usage(const char *program)
+{
+    fprintf(stderr,
+            "usage: %s [options]\n"
+            "  --mode NAME      mode to run (see --list)\n"
+            "  --seconds N      simulated seconds to run for (default 10)\n"
+            "  --step MS        simulated milliseconds between calls to loop() (default 1)\n"
+            "  --out DIR        directory for the frames (default frames)\n"
+            "  --size N         pixels per LED in the images (default 8)\n"
+            "  --time EPOCH     local time the simulated clock starts at\n"
+            "  --benchmark N    time N frames of every mode and exit\n"
+            "  --list           list the modes\n",
+            program);
+    exit(1);
+}
+
+// (pio test -e native links the tests in test/ instead)
+#ifndef PIO_UNIT_TESTING
+int main(int argc, char *argv[])
+{
+    const char *mode = NULL;
+    unsigned long seconds = 10;
+    unsigned long step = 1;
+    int benchmarkFrames = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+
+        if (!strcmp(arg, "--list"))
+        {
+            for (int x = 0; x < marblemadnessModes; x++)
+                printf("%s\n", getMarbleMadnessMode(x));
+            return 0;
+        }
+        if (!value)
+            usage(argv[0]);
+        i++;
+
+        if (!strcmp(arg, "--mode"))
+            mode = value;
+        else if (!strcmp(arg, "--seconds"))
+            seconds = strtoul(value, NULL, 0);
+        else if (!strcmp(arg, "--step"))
+            step = strtoul(value, NULL, 0);
+        else if (!strcmp(arg, "--out"))
+            outputDir = value;
+        else if (!strcmp(arg, "--size"))
+            pixelSize = atoi(value);
+        else if (!strcmp(arg, "--time"))
+            native_epoch = strtoll(value, NULL, 0);
+        else if (!strcmp(arg, "--benchmark"))
+            benchmarkFrames = atoi(value);
+        else
+            usage(argv[0]);
+    }
+    if (!step || pixelSize < 1)
+        usage(argv[0]);
+
+    if (!benchmarkFrames)
+    {
+        mkdir(outputDir, 0777);
+        native_show_hook = write_frame;
+    }
+
+    if (mode)
+    {
+        int x = 0;
+        while (x < marblemadnessModes && strcasecmp(getMarbleMadnessMode(x), mode))
+            x++;
+        if (x == marblemadnessModes)
+        {
+            fprintf(stderr, "unknown mode %s (see --list)\n", mode);
+            return 1;
+        }
+    }
+
+    setup();
+    if (benchmarkFrames > 0)
+    {
+        benchmark_run(benchmarkFrames);
+        fflush(stdout);
+        _exit(0);
+    }
+    if (mode)
+        setMarbleMadnessMode(mode);
+
+    unsigned long end = millis() + seconds * 1000;
+    while (millis() < end)
+    {
+        loop();
+        native_clock_advance(step);
+    }
+
+    // let the output task send the last frame
+    native_clock_advance(100);
+    printf("%u frames written to %s\n", framesWritten, outputDir);
+
+    // the other tasks are still blocked in their loops
+    fflush(stdout);
+    _exit(0);
+}
+#endif // PIO_UNIT_TESTING
@@ -19,15 +19,15 @@ void mode_test()
     timer.setPeriod(MAX_MILLIS - map(settings.speed, MIN_SPEED, MAX_SPEED, MIN_MILLIS, MAX_MILLIS));
 
     // erase the last pixel
-    leds[index] = CRGB::Black; // off
+    leds[PhysicalToLogical(index)] = CRGB::Black; // off
 
-    // move to the next pixel
-    if (++index >= NUM_LEDS)
+    // move to the next pixel along the strips
+    if (++index >= NUM_PHYSICAL_LEDS)
       index = 0;
     DB_PRINTLN(index);
 
     // light up the next pixel
-    leds[index] = CRGB::Red;
+    leds[PhysicalToLogical(index)] = CRGB::Red;
 
     leds_dirty = true;
   }
@@ -61,7 +61,9 @@ void mode_xy_test()
     DB_PRINT(" y = ");
     DB_PRINT(y);
     DB_PRINT(" index = ");
-    DB_PRINTLN(index);
+    DB_PRINT(index);
+    DB_PRINT(" led = ");
+    DB_PRINTLN(XYLookup.index[index]);
 
     // light up the next pixel
     leds[index] = CRGB::Red;
@@ -2,6 +2,7 @@
 #include "debug.h"
 #include "settings.h"
 #include "render.h"
+#include "pixelops.h"
 #include "MarbleRoller.h"
 
 #define DEFAULT_MILLIS 75
@@ -10,7 +11,7 @@
 
 static CRGB marble_colors[] = {
     CRGB::AliceBlue, CRGB::Amethyst, CRGB::AntiqueWhite, CRGB::Aqua, CRGB::Aquamarine, CRGB::Azure,
-    CRGB::Beige, CRGB::Bisque, CRGB::Black, CRGB::BlanchedAlmond, CRGB::Blue, CRGB::BlueViolet,
+    CRGB::Beige, CRGB::Bisque, CRGB::BlanchedAlmond, CRGB::Blue, CRGB::BlueViolet,
     CRGB::Brown, CRGB::BurlyWood, CRGB::CadetBlue, CRGB::Chartreuse, CRGB::Chocolate, CRGB::Coral,
     CRGB::CornflowerBlue, CRGB::Cornsilk, CRGB::Crimson, CRGB::Cyan, CRGB::DarkBlue, CRGB::DarkCyan,
     CRGB::DarkGoldenrod, CRGB::DarkGray, CRGB::DarkGreen, CRGB::DarkKhaki, CRGB::DarkMagenta, CRGB::DarkOliveGreen,
@@ -35,14 +36,28 @@ static CRGB marble_colors[] = {
     CRGB::WhiteSmoke, CRGB::Yellow, CRGB::YellowGreen};
 static int marble_count = (sizeof(marble_colors) / sizeof(marble_colors[0])); // total number of valid marble colors in table
 
-static bool is_marble(CRGB color)
+// Marbles are entities rather than colors in the frame buffer: each one knows where it
+// is along the strips (in wiring order) and its color. The trails they leave behind are
+// kept in their own buffer which is faded each step and the marbles drawn on top, so a
+// step costs one bulk fade plus a few operations per marble.
+#define MAX_MARBLES 64
+
+typedef struct
 {
-    for (int i = 0; i < marble_count; i++)
-    {
-        if (color == marble_colors[i])
-            return true;
-    }
-    return false;
+    uint16_t position; // physical index, marbles roll toward 0
+    CRGB color;
+} marble_t;
+
+static marble_t marbles[MAX_MARBLES];
+static int marbles_active = 0;
+
+// the trails in row-major order (plus the hidden pixel for LEDs that aren't wired to an (x, y))
+alignas(4) static CRGB trails[NUM_LEDS + 1];
+
+void marbleroller_enter()
+{
+    marbles_active = 0;
+    memset(trails, 0, sizeof(trails));
 }
 
 void mode_marbleroller()
@@ -51,33 +66,36 @@ void mode_marbleroller()
     {
         timer.setPeriod(MAX_MILLIS - map(settings.speed, MIN_SPEED, MAX_SPEED, MIN_MILLIS, MAX_MILLIS));
 
-        // start with last LED to allow proper overlapping
-        bool emptyScreen = true;
-        for (int i = 0; i < NUM_LEDS; i++)
-        {
-            // if this is a marble
-            if (is_marble(leds[i]))
-            {
-                // if not on the last LED, add a new marble in the next position of the same color
-                if (i > 0)
-                {
-                    leds[i - 1] = leds[i];
-                    emptyScreen = false;
-                }
+        // fade the existing trails
+        pixels_fade(trails, NUM_LEDS, 191); // Dim by 75%
 
-                // turn the old marble position into the beginning of a trail
-                leds[i].fadeToBlackBy(191); // Dim by 75%
-            }
-            else
+        // marbles roll along the strips in wiring order (the serpentine path through the rows)
+        // leaving the beginning of a trail where they were (a marble on the last LED just fades out)
+        for (int m = 0; m < marbles_active;)
+        {
+            marble_t &marble = marbles[m];
+            trails[PhysicalToLogical(marble.position)] = CRGB(marble.color).nscale8(64);
+            if (marble.position == 0)
             {
-                // Fade all trailing LEDs
-                leds[i].fadeToBlackBy(191); // Dim by 50%
+                marble = marbles[--marbles_active];
+                continue;
             }
+            marble.position--;
+            m++;
         }
 
         // spawn new falling marble at beginning of run
-        if (random8(4 * NUM_COLS) == 0 || emptyScreen) // lower number == more frequent spawns
-            leds[NUM_LEDS - 1] = marble_colors[random8(marble_count)];
+        if ((random8(4 * NUM_COLS) == 0 || marbles_active == 0) && marbles_active < MAX_MARBLES) // lower number == more frequent spawns
+        {
+            marbles[marbles_active++] = {NUM_PHYSICAL_LEDS - 1, marble_colors[random8(marble_count)]};
+        }
+
+        // draw the marbles over their trails
+        memcpy(leds, trails, sizeof(CRGB) * NUM_LEDS);
+        for (int m = 0; m < marbles_active; m++)
+        {
+            leds[PhysicalToLogical(marbles[m].position)] = marbles[m].color;
+        }
 
         leds_dirty = true;
     }
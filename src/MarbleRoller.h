@@ -1,6 +1,7 @@
 #ifndef MARBLEROLLER_H
 #define MARBLEROLLER_H
 
+void marbleroller_enter();
 void mode_marbleroller();
 
 #endif // MARBLEROLLER_H
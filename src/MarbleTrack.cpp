@@ -2,6 +2,7 @@
 #include "debug.h"
 #include "settings.h"
 #include "render.h"
+#include "pixelops.h"
 #include "MarbleTrack.h"
 
 #define DEFAULT_MILLIS 75
@@ -35,46 +36,170 @@ static CRGB marble_colors[] = {
     CRGB::WhiteSmoke, CRGB::Yellow, CRGB::YellowGreen};
 static int marble_count = (sizeof(marble_colors) / sizeof(marble_colors[0])); // total number of valid marble colors in table
 
-static bool is_marble(CRGB color)
+#define TRACK_COLOR CRGB(0x161616)
+
+// the track is every other row, alternately open at the right and left ends
+/*
+x=1 -> 18, y=0
+x=0 -> 17, y=2
+x=1 -> 18, y=4
+x=0 -> 17, y=6
+...
+*/
+constexpr bool is_track(int x, int y)
 {
-    for (int i = 0; i < marble_count; i++)
-    {
-        if (color == marble_colors[i])
-            return true;
-    }
-    return false;
+    if (y % 2)
+        return false;
+    return (y % 4 == 0) ? x >= 1 : x < NUM_COLS - 1;
 }
 
-void marbletrack_enter()
+// ----- the path -----
+// The route a marble takes is worked out by the compiler: start at the top left and
+// fall whenever there is no track below, otherwise roll right on rows 1, 5, 9... and
+// left on rows 3, 7, 11... until reaching the bottom row. Each waypoint also says how
+// many waypoints (starting with itself) must be free before a marble can move onto
+// it. That is 1 except at the top of a drop where the whole drop and the landing spot
+// must be clear, so marbles go down one at a time and queue up behind each drop.
+typedef struct
 {
-    DB_PRINTLN("Entering MarbleTrack mode");
+    uint16_t led;  // index into leds[]
+    uint8_t clear; // waypoints that must be free to move here
+} waypoint_t;
 
-    // draw the track
-    /*
-    x=1 -> 18, y=0
-    x=1 -> 18, y=2
-    x=0 -> 17, y=4
-    x=1 -> 18, y=6
-    x=0 -> 17, y=8
-    x=1 -> 18, y=10
-    */
-    for (int y = 0; y < NUM_ROWS; y += 2)
+struct TrackPath
+{
+    waypoint_t waypoints[NUM_LEDS];
+    uint16_t count;
+};
+
+constexpr TrackPath makeTrackPath()
+{
+    TrackPath path = {};
+    int x = 0, y = 0;
+    while (true)
     {
-        if (y % 4 == 0)
+        path.waypoints[path.count++] = {(uint16_t)(y * NUM_COLS + x), 1};
+        if (y >= NUM_ROWS - 1)
+            break;
+
+        if (!is_track(x, y + 1))
+            y++; // if the spot below us is open, move down
+        else if ((y - 1) % 4)
+            x--; // go left on rows 3, 7, 11, 15
+        else
+            x++; // rows 1, 5, 9, 13, 17 go right
+
+        // stop if the rules ever lead off the panel or onto the track
+        if (x < 0 || x >= NUM_COLS || is_track(x, y))
+            break;
+    }
+
+    // mark the tops of the drops
+    for (uint16_t i = 0; i + 1 < path.count; i++)
+    {
+        bool down = path.waypoints[i + 1].led == path.waypoints[i].led + NUM_COLS;
+        bool arrivedDown = i > 0 && path.waypoints[i].led == path.waypoints[i - 1].led + NUM_COLS;
+        if (down && !arrivedDown)
         {
-            for (int x = 1; x < NUM_COLS; x++)
+            uint16_t end = i + 1;
+            while (end + 1 < path.count && path.waypoints[end + 1].led == path.waypoints[end].led + NUM_COLS)
             {
-                leds[XY(x, y)] = CRGB(0x161616);
+                end++;
             }
+            path.waypoints[i].clear = end - i + 1;
         }
-        else
+    }
+    return path;
+}
+
+static constexpr TrackPath trackPath = makeTrackPath();
+
+// ----- the marbles -----
+// The marbles on the track are a queue in the order they'll leave it (they can't pass
+// each other), with a bit per waypoint to say if a marble is on it. Trails are the
+// waypoints marbles have left and are faded until they go black, so a step only
+// touches the LEDs that changed.
+#define MAX_MARBLES 64
+#define MAX_TRAILS (4 * MAX_MARBLES) // a trail is black after 4 steps and each step leaves at most one per marble
+
+typedef struct
+{
+    uint16_t waypoint;
+    CRGB color;
+} marble_t;
+
+static marble_t marbles[MAX_MARBLES];
+static uint8_t marbles_head = 0; // the marble furthest along
+static uint8_t marbles_active = 0;
+
+static uint32_t occupied[(NUM_LEDS + 31) / 32];
+
+static uint16_t trails[MAX_TRAILS];
+static uint16_t trails_active = 0;
+
+static inline bool is_occupied(uint16_t waypoint)
+{
+    return occupied[waypoint / 32] & (1u << (waypoint % 32));
+}
+
+static inline void set_occupied(uint16_t waypoint, bool on)
+{
+    if (on)
+        occupied[waypoint / 32] |= 1u << (waypoint % 32);
+    else
+        occupied[waypoint / 32] &= ~(1u << (waypoint % 32));
+}
+
+// can a marble move onto waypoint?
+static bool is_clear(uint16_t waypoint)
+{
+    uint16_t end = waypoint + trackPath.waypoints[waypoint].clear;
+    if (end > trackPath.count)
+        end = trackPath.count;
+    for (uint16_t w = waypoint; w < end; w++)
+    {
+        if (is_occupied(w))
+            return false;
+    }
+    return true;
+}
+
+// a marble leaves waypoint, turning it into the beginning of a trail
+static void leave_waypoint(uint16_t waypoint, const CRGB &color)
+{
+    set_occupied(waypoint, false);
+    leds[trackPath.waypoints[waypoint].led] = CRGB(color).nscale8(64); // Dim by 75%
+    if (trails_active < MAX_TRAILS)
+        trails[trails_active++] = waypoint;
+}
+
+static void enter_waypoint(uint16_t waypoint, const CRGB &color)
+{
+    set_occupied(waypoint, true);
+    leds[trackPath.waypoints[waypoint].led] = color;
+}
+
+static void draw_track()
+{
+    for (int y = 0; y < NUM_ROWS; y += 2)
+    {
+        for (int x = 0; x < NUM_COLS; x++)
         {
-            for (int x = 0; x < NUM_COLS - 1; x++)
-            {
-                leds[XY(x, y)] = CRGB(0x161616);
-            }
+            if (is_track(x, y))
+                leds[XY(x, y)] = TRACK_COLOR;
         }
     }
+}
+
+void marbletrack_enter()
+{
+    DB_PRINTLN("Entering MarbleTrack mode");
+
+    marbles_head = marbles_active = 0;
+    trails_active = 0;
+    memset(occupied, 0, sizeof(occupied));
+
+    draw_track();
     leds_dirty = true;
 }
 
@@ -84,50 +209,50 @@ void marbletrack_loop()
     {
         timer.setPeriod(MAX_MILLIS - map(settings.speed, MIN_SPEED, MAX_SPEED, MIN_MILLIS, MAX_MILLIS));
 
-        // traverse the path with simple logic
-        static int x = NUM_COLS - 1;
-        static int y = NUM_ROWS - 1;
-
-        // check if we need to reset to the top
-        if (y >= NUM_ROWS - 1)
-        {
-            // clear the previous marble position
-            leds[XY(x, y)] = CRGB::Black;
-            x = y = 0;
-        }
-        else if ((leds[XY(x, y + 1)] == CRGB::Black))
-        {
-            // if the spot below us is open, move down
-            y++;
-        }
-        else if ((y - 1) % 4)
+        // fade the trails, forgetting the ones that have gone black or have a marble on them again
+        for (uint16_t t = 0; t < trails_active;)
         {
-            // go left on rows 3, 7, 11, 15
-            x--;
+            CRGB &led = leds[trackPath.waypoints[trails[t]].led];
+            if (!is_occupied(trails[t]))
+                led.nscale8(64); // Dim by 75%
+            if (is_occupied(trails[t]) || !led)
+            {
+                trails[t] = trails[--trails_active];
+                continue;
+            }
+            t++;
         }
-        else
+
+        // the marble at the end of the track rolls off
+        if (marbles_active && marbles[marbles_head].waypoint == trackPath.count - 1)
         {
-            // rows 1, 5, 9, 13, 17 go right
-            x++;
+            leave_waypoint(marbles[marbles_head].waypoint, marbles[marbles_head].color);
+            marbles_head = (marbles_head + 1) % MAX_MARBLES;
+            marbles_active--;
         }
-        //        DB_PRINTF("Marble at %d,%d\n", x, y);
-        leds[XY(x, y)] = CRGB::Red;
 
-        for (int i = 0; i < NUM_LEDS; i++)
+        // the rest move along, front to back so a line of marbles moves together, unless
+        // the way ahead is blocked
+        for (uint8_t i = 0; i < marbles_active; i++)
         {
-            // if this is a marble
-            if (leds[i] == CRGB::Red)
+            marble_t &marble = marbles[(marbles_head + i) % MAX_MARBLES];
+            uint16_t next = marble.waypoint + 1;
+            if (is_clear(next))
             {
-                // turn the old marble position into the beginning of a trail
-                leds[i].fadeToBlackBy(191); // Dim by 75%
-            }
-            else if (leds[i] != CRGB(0x161616))
-            {
-                // Fade all trailing LEDs
-                leds[i].fadeToBlackBy(191); // Dim by 75%
+                leave_waypoint(marble.waypoint, marble.color);
+                marble.waypoint = next;
+                enter_waypoint(next, marble.color);
             }
         }
 
+        // new marbles start at the top left when there is room
+        if (marbles_active < MAX_MARBLES && is_clear(0) && (random8(3) == 0 || marbles_active == 0)) // lower number == more frequent spawns
+        {
+            marble_t &marble = marbles[(marbles_head + marbles_active++) % MAX_MARBLES];
+            marble = {0, marble_colors[random8(marble_count)]};
+            enter_waypoint(0, marble.color);
+        }
+
         leds_dirty = true;
     }
 }
@@ -5,6 +5,7 @@
 #include "render.h"
 #include <Time.h>
 #include "RealTimeClock.h"
+#include "displaylist.h"
 #include "displaynumbers.h"
 
 /* Useful Constants */
@@ -38,6 +39,10 @@ ClockFace clockFaceLUT[]{
     {drawAnalogClock, "Analog"}};
 int clockFaces = (sizeof(clockFaceLUT) / sizeof(clockFaceLUT[0])); // total number of valid face names in table
 
+// The clock face is drawn on its own display list layer which is composited over every
+// frame as it is shown, so it only needs to be redrawn when the time, face or color changes.
+static volatile bool clock_dirty = true;
+
 void drawClock()
 {
     clockFaceLUT[settings.clockFace].renderFunc();
@@ -58,7 +63,7 @@ int setClockFace(const char *clockFace)
         if (String(clockFaceLUT[x].faceName).equalsIgnoreCase(String(clockFace)))
         {
             settings.clockFace = x;
-            leds_dirty = true;
+            clock_dirty = true;
             DB_PRINTF("setClockFace = %s\r\n", clockFace);
             break;
         }
@@ -70,7 +75,7 @@ int setClockFace(const char *clockFace)
 CRGB setClockColor(const CRGB clockColor)
 {
     settings.clockColor = clockColor;
-    leds_dirty = true;
+    clock_dirty = true;
     DB_PRINTF("setClockColor = #%06X\r\n", settings.clockColor.r << 16 | settings.clockColor.g << 8 | settings.clockColor.b);
 
     return settings.clockColor;
@@ -120,6 +125,25 @@ int ConvertMilitaryTime(int hours)
 
 void drawNullClock()
 {
+    if (clock_dirty)
+    {
+        dl_clear(LAYER_CLOCK);
+        clock_dirty = false;
+    }
+}
+
+// the four digits of HH:MM (12 hour)
+static bool getClockDigits(int digits[4], struct tm &timeinfo)
+{
+    if (!getLocalTime(&timeinfo))
+        return false;
+
+    int hours = ConvertMilitaryTime(timeinfo.tm_hour);
+    digits[0] = hours / 10;
+    digits[1] = hours % 10;
+    digits[2] = timeinfo.tm_min / 10;
+    digits[3] = timeinfo.tm_min % 10;
+    return true;
 }
 
 void drawDigitalClock()
@@ -129,11 +153,24 @@ void drawDigitalClock()
     const int totalH = 5;
     const int startX = (NUM_COLS - totalW) / 2; // = 1
     const int startY = (NUM_ROWS - totalH) / 2; // = 7
-    drawDigitalClock(startX, startY, setLEDBlendClockColor);
-}
+    static int shown[4] = {-1, -1, -1, -1};
+    struct tm timeinfo;
+    int digits[4];
 
-// https://wokwi.com/arduino/projects/286985034843292172
-#include "wuLineAA.h"
+    if (getClockDigits(digits, timeinfo))
+    {
+        if (clock_dirty || memcmp(digits, shown, sizeof(digits)))
+        {
+            if (digits[3] != shown[3])
+                DB_PRINTLN(&timeinfo, "%A, %B %d %Y %I:%M:%S %p");
+            memcpy(shown, digits, sizeof(shown));
+            clock_dirty = false;
+
+            dl_clear(LAYER_CLOCK);
+            drawTime17x5(digits[0], digits[1], digits[2], digits[3], startX, startY, LAYER_CLOCK, settings.clockColor);
+        }
+    }
+}
 
 // https://mathopenref.com/coordparamellipse.html
 void wuVectorAA(const uint16_t x, const uint16_t y, const uint16_t a, const uint16_t b, const uint16_t theta, CRGB *col)
@@ -141,7 +178,7 @@ void wuVectorAA(const uint16_t x, const uint16_t y, const uint16_t a, const uint
     int16_t dx, dy;
     dx = (a * (int32_t)cos16(theta)) / 32768;
     dy = (b * (int32_t)sin16(theta)) / 32768;
-    wuLineAA(x, y, x + dx, y + dy, col);
+    dl_line(LAYER_CLOCK, x, y, x + dx, y + dy, *col);
 }
 
 // https://wokwi.com/arduino/projects/286985034843292172
@@ -213,7 +250,7 @@ void drawAnalogClock()
             y1 = (b * 3 / 4 * (int32_t)sin16(base_theta + theta)) / 32768;
             x2 = (a * (int32_t)cos16(base_theta + theta)) / 32768;
             y2 = (b * (int32_t)sin16(base_theta + theta)) / 32768;
-            wuLineAA(centrex + x1, centrey + y1, centrex + x2, centrey + y2, &settings.clockColor);
+            dl_line(LAYER_CLOCK, centrex + x1, centrey + y1, centrex + x2, centrey + y2, settings.clockColor);
         }
 #else
         uint16_t index;
@@ -263,6 +300,7 @@ void drawAnalogClock()
 
     if (getLocalTime(&timeinfo))
     {
+        bool changed = clock_dirty;
         int tmp;
 
         // compute hours
@@ -270,7 +308,7 @@ void drawAnalogClock()
         if (hours != tmp)
         {
             hours = tmp;
-            leds_dirty = true;
+            changed = true;
         }
 
         // compute minutes
@@ -278,7 +316,7 @@ void drawAnalogClock()
         if (minutes != tmp)
         {
             minutes = tmp;
-            leds_dirty = true;
+            changed = true;
         }
 
         // compute seconds
@@ -286,62 +324,26 @@ void drawAnalogClock()
         if (seconds != tmp)
         {
             seconds = tmp;
-            leds_dirty = true;
+            changed = true;
             DB_PRINTLN(&timeinfo, "%A, %B %d %Y %I:%M:%S %p");
         }
 
-        if (leds_dirty)
+        if (changed)
+        {
+            clock_dirty = false;
+            dl_clear(LAYER_CLOCK);
             displayHands(hours, minutes, seconds, settings.clockColor);
+        }
     }
 }
 
 void drawDigitalClock(int xOffset, int yOffset, setLEDFunction setLED)
 {
     struct tm timeinfo;
-    static int digit1 = -1, digit2 = -1, digit3 = -1, digit4 = -1;
-
-    if (getLocalTime(&timeinfo))
-    {
-        int tmp;
-
-        // compute first digit of hours
-        tmp = ConvertMilitaryTime(timeinfo.tm_hour);
-        tmp /= 10;
-        if (digit1 != tmp)
-        {
-            digit1 = tmp;
-            leds_dirty = true;
-        }
-
-        // compute second digit of hours
-        tmp = ConvertMilitaryTime(timeinfo.tm_hour) % 10;
-        if (digit2 != tmp)
-        {
-            digit2 = tmp;
-            leds_dirty = true;
-        }
+    int digits[4];
 
-        // compute first digit of minutes
-        tmp = timeinfo.tm_min;
-        tmp /= 10;
-        if (digit3 != tmp)
-        {
-            digit3 = tmp;
-            leds_dirty = true;
-        }
-
-        // compute second digit of minutes
-        tmp = timeinfo.tm_min % 10;
-        if (digit4 != tmp)
-        {
-            digit4 = tmp;
-            leds_dirty = true;
-            DB_PRINTLN(&timeinfo, "%A, %B %d %Y %I:%M:%S %p");
-        }
-
-        if (leds_dirty)
-            drawTime17x5(digit1, digit2, digit3, digit4, xOffset, yOffset, setLED);
-    }
+    if (getClockDigits(digits, timeinfo))
+        drawTime17x5(digits[0], digits[1], digits[2], digits[3], xOffset, yOffset, setLED);
 }
 
 #endif // TIME
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include "debug.h"
 #include "render.h"
 #include "physics.h"
+#include "displaylist.h"
 #include "Ringer.h"
 
 // Track our marbles so we can move them around
@@ -35,7 +36,7 @@ static void ResetMarbles()
         break;
     }
     position = {px, py};
-    b2Body_SetTransform(marbles[0], position, b2MakeRot(0.0f)); // Move to new location
+    physics_set_transform(marbles[0], position); // Move to new location
 
     // Compute direction vector from spawn point to center
     float cx = (float)(WIDTH / 2);
@@ -56,25 +57,22 @@ static void ResetMarbles()
         dx = 0.0f;
         dy = speed;
     }
-    b2Body_SetLinearVelocity(marbles[0], (b2Vec2){dx, dy});
+    physics_set_velocity(marbles[0], (b2Vec2){dx, dy});
 
     // move marbles to random positions around the center
     for (int i = 1; i < MARBLE_COUNT; ++i)
     {
         position = {(float)(random(WIDTH * 1 / 3, WIDTH * 2 / 3)), (float)(random(HEIGHT * 1 / 3, HEIGHT * 2 / 3))};
-        b2Body_SetTransform(marbles[i], position, b2MakeRot(0.0f)); // Move to new location
-        b2Body_SetLinearVelocity(marbles[i], (b2Vec2){0, 0});
-        b2Body_SetAngularVelocity(marbles[i], 0.0f); // Stop spin
+        physics_set_transform(marbles[i], position); // Move to new location
+        physics_set_velocity(marbles[i], (b2Vec2){0, 0}); // Stop it (and any spin)
     }
 }
 
 // ----- Physics setup -----
 static void setupWorld()
 {
-    // create the world
-    b2WorldDef worldDef = b2DefaultWorldDef();
-    worldDef.gravity = (b2Vec2){0.0f, 0.0f};
-    world = b2CreateWorld(&worldDef);
+    // get the (reused) world ready
+    physics_reset((b2Vec2){0.0f, 0.0f});
 
 #if 0
     // make a box the marbles can bounce around in
@@ -124,17 +122,17 @@ void ringer_loop()
         };
 
         // Draw marbles at their current positions
-        FastLED.clear();
+        const physics_snapshot_t *snapshot = physics_snapshot();
+        dl_clear(LAYER_MARBLES);
         for (int i = 0; i < MARBLE_COUNT; ++i)
         {
-            if (!b2Body_IsValid(marbles[i]))
+            b2Vec2 position;
+            if (!physics_position(snapshot, marbles[i], position))
                 continue;
 
-            b2Vec2 position = b2Body_GetPosition(marbles[i]);
-            int gx = (int)lroundf(position.x);
-            int gy = HEIGHT - (int)lroundf(position.y);
-            leds[XY(gx, gy)] = colors[i % (sizeof(colors) / sizeof(colors[0]))];
+            dl_marble(LAYER_MARBLES, position.x, HEIGHT - position.y, colors[i % (sizeof(colors) / sizeof(colors[0]))]);
         }
+        dl_render();
 
         leds_dirty = true;
     }
@@ -145,12 +143,7 @@ void ringer_loop()
         //        DB_PRINTF("Free heap: %u bytes | Largest block: %u bytes\r\n", heap_caps_get_free_size(MALLOC_CAP_8BIT), heap_caps_get_largest_free_block(MALLOC_CAP_8BIT));
         //        DB_PRINTF("Physics stack high watermark: %d bytes\r\n", uxTaskGetStackHighWaterMark(physicsTaskHandle));
 
-        // make sure we can get the world mutex before resetting the world
-        if (xSemaphoreTake(worldMutex, portMAX_DELAY))
-        {
-            // Move marbles to new random positions above the visible area
-            ResetMarbles();
-            xSemaphoreGive(worldMutex);
-        }
+        // Move marbles to new random positions above the visible area
+        ResetMarbles();
     }
 }
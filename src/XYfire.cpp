@@ -1,6 +1,7 @@
 #include "main.h"
 #include "settings.h"
 #include "render.h"
+#include "pixelops.h"
 #include "XYfire.h"
 
 #define DEFAULT_MILLIS 100
@@ -17,9 +18,12 @@ void mode_xy_fire()
     {
         timer.setPeriod(MAX_MILLIS - map(settings.speed, MIN_SPEED, MAX_SPEED, MIN_MILLIS, MAX_MILLIS));
         t += speed;
-        for (byte x = 0; x < NUM_COLS; x++)
+        // noise row y is blended into frame row NUM_ROWS - y, a row at a time (row 0 is never drawn
+        // and noise row 0 would land below the bottom of the frame)
+        CRGB overlay[NUM_COLS];
+        for (byte y = 1; y < NUM_ROWS; y++)
         {
-            for (byte y = 0; y < NUM_ROWS; y++)
+            for (byte x = 0; x < NUM_COLS; x++)
             {
 
                 int16_t Bri = inoise8(x * scale, (y * scale) - t) - (y * (255 / NUM_ROWS));
@@ -28,8 +32,9 @@ void mode_xy_fire()
                     Bri = 0;
                 if (Bri != 0)
                     Bri = 256 - (Bri * 0.2);
-                nblend(leds[XY(x, NUM_ROWS - y)], ColorFromPalette(HeatColors_p, Col, Bri), speed);
+                overlay[x] = ColorFromPalette(HeatColors_p, Col, Bri);
             }
+            pixels_blend(frame_row(NUM_ROWS - y), overlay, NUM_COLS, speed);
         }
 
         leds_dirty = true;
@@ -0,0 +1,253 @@
+#ifndef XYMAP_H
+#define XYMAP_H
+
+//
+// Compile time (x, y) -> physical_leds[] remap tables.
+//
+// The serpentine math below used to run on every pixel write. It is now only
+// evaluated by the compiler to fill XYLookup, which render_show() uses to
+// convert the row-major frame buffer to wiring order in one pass. Pick the
+// wiring of the panel with one of BOTTOM_RIGHT, TOP_LEFT or COMPLEX_SHAPE
+// (see render.h).
+//
+
+#ifdef COMPLEX_SHAPE
+//
+// I have implemented two different X,Y mapping modes. The first pairs adjacent strips of LEDs into a single x coordinate
+// as they are paired in the triangle columns. The second (WIDERTHANTALLER) maps each strip to a separate x coordinate.
+//
+#define STRIP_0_NUM_COLS 6
+#define STRIP_1_NUM_COLS 4
+#define STRIP_2_NUM_COLS 4
+#define STRIP_3_NUM_COLS 6
+
+inline constexpr uint8_t XYComplexTable[NUM_ROWS * NUM_COLS / 2] = {
+    //
+    // This array helps translate from a (x,y) coordinate to the correct offset in the leds[] array.
+    // To get the best visual results, we are combining columns as the triangles are interleaved
+    // vertically. This gives us an effective resolution of (20 x 39) pixels with missing corners
+    // where the hexaqgon shape doesn't fill the square. Any (x, y) coordinates that aren't valid
+    // LED positions, return a value that is within the leds[] array but doesn't have a corresponding
+    // physical LED to make error handling simpler.
+    //
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 19,
+    255, 255, 255, 255, 255, 255, 255, 255, 57, 20,
+    255, 255, 255, 255, 255, 255, 255, 93, 58, 18,
+    255, 255, 255, 255, 255, 255, 127, 94, 56, 21,
+    255, 255, 255, 255, 255, 15, 128, 92, 59, 17,
+    255, 255, 255, 255, 45, 16, 126, 95, 55, 22,
+    255, 255, 255, 73, 46, 14, 129, 91, 60, 16,
+    255, 255, 99, 74, 44, 17, 125, 96, 54, 23,
+    255, 123, 100, 72, 47, 13, 130, 90, 61, 15,
+    145, 124, 98, 75, 43, 18, 124, 97, 53, 24,
+    146, 122, 101, 71, 48, 12, 131, 89, 62, 14,
+    144, 125, 97, 76, 42, 19, 123, 98, 52, 25,
+    147, 121, 102, 70, 49, 11, 132, 88, 63, 13,
+    143, 126, 96, 77, 41, 20, 122, 99, 51, 26,
+    148, 120, 103, 69, 50, 10, 133, 87, 64, 12,
+    142, 127, 95, 78, 40, 21, 121, 100, 50, 27,
+    149, 119, 104, 68, 51, 9, 134, 86, 65, 11,
+    141, 128, 94, 79, 39, 22, 120, 101, 49, 28,
+    150, 118, 105, 67, 52, 8, 135, 85, 66, 10,
+    140, 129, 93, 80, 38, 23, 119, 102, 48, 29,
+    151, 117, 106, 66, 53, 7, 136, 84, 67, 9,
+    139, 130, 92, 81, 37, 24, 118, 103, 47, 30,
+    152, 116, 107, 65, 54, 6, 137, 83, 68, 8,
+    138, 131, 91, 82, 36, 25, 117, 104, 46, 31,
+    153, 115, 108, 64, 55, 5, 138, 82, 69, 7,
+    137, 132, 90, 83, 35, 26, 116, 105, 45, 32,
+    154, 114, 109, 63, 56, 4, 139, 81, 70, 6,
+    136, 133, 89, 84, 34, 27, 115, 106, 44, 33,
+    155, 113, 110, 62, 57, 3, 140, 80, 71, 5,
+    135, 134, 88, 85, 33, 28, 114, 107, 43, 34,
+    255, 112, 111, 61, 58, 2, 141, 79, 72, 4,
+    255, 255, 87, 86, 32, 29, 113, 108, 42, 35,
+    255, 255, 255, 60, 59, 1, 142, 78, 73, 3,
+    255, 255, 255, 255, 31, 30, 112, 109, 41, 36,
+    255, 255, 255, 255, 255, 0, 143, 77, 74, 2,
+    255, 255, 255, 255, 255, 255, 111, 110, 40, 37,
+    255, 255, 255, 255, 255, 255, 255, 76, 75, 1,
+    255, 255, 255, 255, 255, 255, 255, 255, 39, 38,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 0};
+#else
+// Which rows of the matrix are wired to which strip. Each strip is driven from its own
+// pin and covers a band of ROWS_PER_STRIP whole rows (the last one may be shorter), e.g.
+// with 4 strips: rows 0-4, 5-9, 10-14 and 15-18. Edit this table if the panel is wired
+// in uneven bands; XYLookup follows it.
+struct StripPartition
+{
+  uint8_t firstRow[NUM_STRIPS];
+  uint8_t numRows[NUM_STRIPS];
+};
+
+constexpr StripPartition makeStripPartition()
+{
+  StripPartition partition = {};
+  for (uint8_t strip = 0; strip < NUM_STRIPS; strip++)
+  {
+    uint8_t first = strip * ROWS_PER_STRIP;
+    partition.firstRow[strip] = first;
+    partition.numRows[strip] = (first + ROWS_PER_STRIP <= NUM_ROWS) ? ROWS_PER_STRIP : NUM_ROWS - first;
+  }
+  return partition;
+}
+
+inline constexpr StripPartition StripRows = makeStripPartition();
+#endif // COMPLEX_SHAPE
+
+// The wiring math for a single in bounds (x, y). Only meant to be evaluated at
+// compile time to build XYLookup; use XY() everywhere else.
+constexpr uint16_t XY_compute(uint16_t x, uint16_t y)
+{
+#if defined(BOTTOM_RIGHT) || defined(TOP_LEFT)
+  // find the strip that drives row y
+  uint8_t strip = 0;
+  while (strip < NUM_STRIPS - 1 && y >= StripRows.firstRow[strip] + StripRows.numRows[strip])
+  {
+    strip++;
+  }
+  uint16_t first_index = strip * NUM_LEDS_PER_STRIP;
+#endif
+
+  // Calculate the LED index based on a serpintine mapping
+#ifdef BOTTOM_RIGHT
+  // (0,0) is top left, the strip starts at the bottom right of its band of rows
+  // (with one strip: (0,0) is index 360, (18,18) is index 0)
+  // each strip is a single row of the XY matrix
+  uint16_t row = (StripRows.firstRow[strip] + StripRows.numRows[strip] - 1) - y;
+
+  if (row % 2 == 0)
+  {
+    // Even row (counting up from the bottom of the band): right to left
+    return first_index + row * NUM_COLS + (NUM_COLS - 1 - x);
+  }
+  else
+  {
+    // Odd row: left to right
+    return first_index + row * NUM_COLS + x;
+  }
+#endif // BOTTOM_RIGHT
+#ifdef TOP_LEFT
+  // (0,0) is top left, the strip starts at the top left of its band of rows
+  // (with one strip: (0,0) is index 0, (18,18) is index 360)
+  // each strip is a single row of the XY matrix
+  uint16_t row = y - StripRows.firstRow[strip];
+
+  if (row % 2 == 0)
+  {
+    // Even row: left-to-right
+    return first_index + row * NUM_COLS + x;
+  }
+  else
+  {
+    // Odd row: right-to-left
+    return first_index + row * NUM_COLS + (NUM_COLS - 1 - x);
+  }
+#endif // TOP_LEFT
+#ifdef COMPLEX_SHAPE
+  // Compute the index into the lookup table taking into account the fact that the table
+  // only contains 1/2 the columns to save space. The right have are just mirrored from
+  // the left half.
+  uint16_t tableIndex = (y * NUM_COLS / 2);
+  if (x < NUM_COLS / 2)
+  {
+    tableIndex += x;
+  }
+  else
+  {
+    tableIndex += NUM_COLS - x - 1;
+  }
+  uint16_t stripOffset = XYComplexTable[tableIndex];
+  uint8_t strip = 0;
+
+  // if we are returning an out of bounds value for an individual strip, return the first hidden LED instead
+  // to make error handling easier.
+  if (stripOffset >= NUM_LEDS_PER_STRIP)
+    return PHYSICAL_OUTOFBOUNDS;
+
+  if (x < STRIP_0_NUM_COLS)
+  {
+    strip = 0;
+  }
+  else if (x < STRIP_0_NUM_COLS + STRIP_1_NUM_COLS)
+  {
+    strip = 1;
+  }
+  else if (x < STRIP_0_NUM_COLS + STRIP_1_NUM_COLS + STRIP_2_NUM_COLS)
+  {
+    strip = 2;
+  }
+  else
+  {
+    strip = 3;
+  }
+
+  return strip * NUM_LEDS_PER_STRIP + stripOffset;
+#endif // COMPLEX_SHAPE
+}
+
+// logical (row-major) index -> physical index
+struct XYLookupTable
+{
+  uint16_t index[NUM_LEDS];
+};
+
+constexpr XYLookupTable makeXYLookupTable()
+{
+  XYLookupTable table = {};
+  for (uint16_t y = 0; y < NUM_ROWS; y++)
+  {
+    for (uint16_t x = 0; x < NUM_COLS; x++)
+    {
+      table.index[y * NUM_COLS + x] = XY_compute(x, y);
+    }
+  }
+  return table;
+}
+
+// physical index -> logical (row-major) index, OUTOFBOUNDS where no (x, y) is wired to the LED
+struct PhysicalLookupTable
+{
+  uint16_t index[NUM_PHYSICAL_LEDS];
+};
+
+constexpr PhysicalLookupTable makePhysicalLookupTable(const XYLookupTable &xy)
+{
+  PhysicalLookupTable table = {};
+  for (uint16_t i = 0; i < NUM_PHYSICAL_LEDS; i++)
+  {
+    table.index[i] = OUTOFBOUNDS;
+  }
+  for (uint16_t i = 0; i < NUM_LEDS; i++)
+  {
+    if (xy.index[i] < NUM_PHYSICAL_LEDS)
+      table.index[xy.index[i]] = i;
+  }
+  return table;
+}
+
+// one shared copy of each table in flash
+inline constexpr XYLookupTable XYLookup = makeXYLookupTable();
+inline constexpr PhysicalLookupTable PhysicalLookup = makePhysicalLookupTable(XYLookup);
+
+// function to map a x, y coordinate to the index into the led array
+// origin (x = 0, y = 0) is at top left
+inline uint16_t XY(uint16_t x, uint16_t y)
+{
+  // any out of bounds address maps to the hidden pixel (negative values wrap to large unsigned values)
+  if ((x >= NUM_COLS) || (y >= NUM_ROWS))
+    return OUTOFBOUNDS;
+
+  return y * NUM_COLS + x;
+}
+
+// function to map the n-th LED along the strips (in wiring order) to the index into the led array
+inline uint16_t PhysicalToLogical(uint16_t physical)
+{
+  if (physical >= NUM_PHYSICAL_LEDS)
+    return OUTOFBOUNDS;
+
+  return PhysicalLookup.index[physical];
+}
+
+#endif // XYMAP_H
@@ -1,6 +1,7 @@
 #include "main.h"
 #include "settings.h"
 #include "render.h"
+#include "pixelops.h"
 #include "XYmatrix.h"
 
 #define DEFAULT_MILLIS 75
@@ -16,6 +17,9 @@ void mode_xy_matrix()
 
         // move code downward
         // start with lowest row to allow proper overlapping on each column
+        // the new code pixels are drawn after the trails fade so they stay at full brightness
+        static uint16_t spawns[NUM_LEDS];
+        int count = 0;
         for (int8_t row = NUM_ROWS - 1; row >= 0; row--)
         {
             for (int8_t col = 0; col < NUM_COLS; col++)
@@ -28,16 +32,16 @@ void mode_xy_matrix()
 
                     // if not on the bottom row, add a new code pixel below it
                     if (row < NUM_ROWS - 1)
-                        leds[XY(col, row + 1)] = CRGB(175, 255, 175);
+                        spawns[count++] = XY(col, row + 1);
                 }
             }
         }
 
         // fade all trailing leds
-        for (int i = 0; i < NUM_LEDS; i++)
+        pixels_scale(leds, NUM_LEDS, 192);
+        for (int i = 0; i < count; i++)
         {
-            if (leds[i].g != 255)
-                leds[i].nscale8(192); // only fade trail
+            leds[spawns[i]] = CRGB(175, 255, 175);
         }
 
         // check for empty screen to ensure code spawn
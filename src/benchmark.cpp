@@ -0,0 +1,98 @@
+#include "main.h"
+#include "render.h"
+#include "pixelops.h"
+#include "modes.h"
+#include "benchmark.h"
+#include <esp_timer.h>
+#include <algorithm>
+
+int64_t benchmark_micros()
+{
+    return esp_timer_get_time();
+}
+
+void benchmark_report(const char *name, uint32_t *samples, uint16_t count, int32_t heapInUse, int32_t heapLeaked)
+{
+    if (!count)
+    {
+        Serial.printf("| %-20s | %6u | %8s | %8s | %8s | %8d | %8d |\r\n", name, 0, "-", "-", "-", (int)heapInUse, (int)heapLeaked);
+        return;
+    }
+
+    std::sort(samples, samples + count);
+    uint16_t p99 = (count * 99 + 99) / 100 - 1;
+    Serial.printf("| %-20s | %6u | %8u | %8u | %8u | %8d | %8d |\r\n", name, count, (unsigned)samples[0], (unsigned)samples[count / 2], (unsigned)samples[p99], (int)heapInUse, (int)heapLeaked);
+}
+
+// the XYLookup table load render_show() does per pixel and XY_compute() over every cell,
+// the bounds and sum go through volatiles so the compiler can't fold the (constexpr) mapping away
+static volatile uint16_t xyCols = NUM_COLS, xyRows = NUM_ROWS;
+static volatile uint16_t xySink;
+
+static void benchmark_xy_lookup()
+{
+    uint16_t cols = xyCols, rows = xyRows, sum = 0;
+    for (uint16_t y = 0; y < rows; y++)
+        for (uint16_t x = 0; x < cols; x++)
+            sum += XYLookup.index[y * NUM_COLS + x];
+    xySink = sum;
+}
+
+static void benchmark_xy_compute()
+{
+    uint16_t cols = xyCols, rows = xyRows, sum = 0;
+    for (uint16_t y = 0; y < rows; y++)
+        for (uint16_t x = 0; x < cols; x++)
+            sum += XY_compute(x, y);
+    xySink = sum;
+}
+
+// time each kernel over a full frame (and its scalar reference), BENCHMARK_REPEAT calls per sample
+static void benchmark_kernels(uint16_t frames)
+{
+    static uint32_t samples[BENCHMARK_MAX_FRAMES];
+    alignas(4) static CRGB overlay[NUM_LEDS];
+    uint16_t count = frames > BENCHMARK_MAX_FRAMES ? BENCHMARK_MAX_FRAMES : frames;
+
+    for (uint16_t i = 0; i < NUM_LEDS; i++)
+    {
+        overlay[i] = CRGB(random8(), random8(), random8());
+    }
+
+#define BENCHMARK_KERNEL(name, call)                                   \
+    for (uint16_t frame = 0; frame < count; frame++)                   \
+    {                                                                  \
+        memcpy(leds, overlay, sizeof(overlay));                        \
+        int64_t start = benchmark_micros();                            \
+        for (uint16_t repeat = 0; repeat < BENCHMARK_REPEAT; repeat++) \
+            call;                                                      \
+        samples[frame] = benchmark_micros() - start;                   \
+    }                                                                  \
+    benchmark_report(name, samples, count, 0, 0);
+
+    BENCHMARK_KERNEL("pixels_scale", pixels_scale(leds, NUM_LEDS, 192));
+    BENCHMARK_KERNEL("pixels_scale_scalar", pixels_scale_scalar(leds, NUM_LEDS, 192));
+    BENCHMARK_KERNEL("pixels_fade", pixels_fade(leds, NUM_LEDS, 191));
+    BENCHMARK_KERNEL("pixels_fade_scalar", pixels_fade_scalar(leds, NUM_LEDS, 191));
+    BENCHMARK_KERNEL("pixels_blend", pixels_blend(leds, overlay, NUM_LEDS, 128));
+    BENCHMARK_KERNEL("pixels_blend_scalar", pixels_blend_scalar(leds, overlay, NUM_LEDS, 128));
+    BENCHMARK_KERNEL("pixels_fill", pixels_fill(leds, NUM_LEDS, CRGB::Red));
+    BENCHMARK_KERNEL("pixels_fill_scalar", pixels_fill_scalar(leds, NUM_LEDS, CRGB::Red));
+    BENCHMARK_KERNEL("XYLookup", benchmark_xy_lookup());
+    BENCHMARK_KERNEL("XY_compute", benchmark_xy_compute());
+
+#undef BENCHMARK_KERNEL
+
+    frame_clear();
+}
+
+void benchmark_run(uint16_t frames)
+{
+    Serial.printf("\r\nBenchmark: %u frames per mode on %s (times in us, heap in bytes, kernel rows are %d calls)\r\n\r\n", frames, ARDUINO_BOARD, BENCHMARK_REPEAT);
+    Serial.printf("| %-20s | %6s | %8s | %8s | %8s | %8s | %8s |\r\n", "", "frames", "min", "median", "p99", "in use", "leaked");
+    Serial.printf("|%s|%s|%s|%s|%s|%s|%s|\r\n", "----------------------", "-------:", "---------:", "---------:", "---------:", "---------:", "---------:");
+
+    benchmarkMarbleMadnessModes(frames);
+    benchmark_kernels(frames);
+    Serial.printf("\r\n");
+}
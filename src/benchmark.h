@@ -0,0 +1,39 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <Arduino.h>
+
+//
+// Frame time benchmark. Every mode in the mode table is entered, rendered until it
+// has drawn a number of frames (or BENCHMARK_MAX_MILLIS has gone by), then left,
+// followed by the pixel kernels against their scalar versions and the XYLookup table
+// against the wiring math (XY_compute()) it replaced. The physics modes get a second
+// row for their world steps. The results are printed as a markdown table so they can
+// be compared from commit to commit.
+//
+// On the device define BENCHMARK (see main.h) to run it from setup(). The native
+// build runs it with --benchmark and its simulated clock makes the windows of
+// EVERY_N_MILLIS() go by instantly.
+//
+
+#define BENCHMARK_FRAMES 100      // frames timed per mode
+#define BENCHMARK_MAX_FRAMES 1000 // most frames that can be timed per row
+#define BENCHMARK_REPEAT 100      // kernel calls per sample (a single call is too quick to time)
+
+// give up on a mode that hasn't drawn enough frames by then (simulated time costs nothing on the host)
+#ifdef NATIVE
+#define BENCHMARK_MAX_MILLIS 600000
+#else
+#define BENCHMARK_MAX_MILLIS 10000
+#endif
+
+// run the whole benchmark (call before the first frame is rendered)
+void benchmark_run(uint16_t frames = BENCHMARK_FRAMES);
+
+// microseconds from the hardware timer (not the simulated clock on the host)
+int64_t benchmark_micros();
+
+// print one row of the table (sorts samples)
+void benchmark_report(const char *name, uint32_t *samples, uint16_t count, int32_t heapInUse, int32_t heapLeaked);
+
+#endif // BENCHMARK_H
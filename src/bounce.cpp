@@ -2,6 +2,7 @@
 #include "debug.h"
 #include "render.h"
 #include "physics.h"
+#include "displaylist.h"
 #include "bounce.h"
 
 // Track our marbles so we can move them around
@@ -15,24 +16,19 @@ static void ResetMarbles()
     {
         float x = (float)(random(0, WIDTH));
         float y = (float)(HEIGHT - random(1, HEIGHT / 4));
-        b2Vec2 position = b2Vec2{x, y};
-        b2Rot rotation = b2MakeRot(0.0f);
-        b2Body_SetTransform(marbles[i], position, rotation); // Move to new location
+        physics_set_transform(marbles[i], (b2Vec2){x, y}); // Move to new location
 
-        // Give each an initial push
+        // Give each an initial push (and stop any spin)
         float vx = (random(-100, 101)) / 50.0f; // ~[-2, 2] m/s
         float vy = (random(10, 151)) / 50.0f;   // ~[0.2, 3] m/s upward
-        b2Body_SetLinearVelocity(marbles[i], (b2Vec2){vx, vy});
-        b2Body_SetAngularVelocity(marbles[i], 0.0f); // Stop spin
+        physics_set_velocity(marbles[i], (b2Vec2){vx, vy});
     }
 }
 
 static void setupWorld()
 {
-    // create the world
-    b2WorldDef worldDef = b2DefaultWorldDef();
-    worldDef.gravity = (b2Vec2){0.0f, -9.8f};
-    world = b2CreateWorld(&worldDef);
+    // get the (reused) world ready
+    physics_reset((b2Vec2){0.0f, -9.8f});
 
     CreateWall((float)WIDTH / 2.0f, -0.125f, (float)WIDTH + 0.5f, 0.25f);                       // floor
     CreateWall(-0.25f, (float)HEIGHT / 2.0f, 0.25f, (float)HEIGHT + 2.0f);                      // left wall
@@ -50,17 +46,11 @@ void bounce_enter()
     // Initializie physics world and start physics task
     DB_PRINTLN("Entering Bounce mode");
     setupWorld();
-    physics_enter();
-
-    // Small delay to ensure physics task is running
-    vTaskDelay(pdMS_TO_TICKS(100));
 
-    // position the marbles (after physics task is running and world is valid)
-    if (xSemaphoreTake(worldMutex, portMAX_DELAY))
-    {
-        ResetMarbles();
-        xSemaphoreGive(worldMutex);
-    }
+    // position the marbles before waking the task so its first step already has them
+    // (the queue takes commands while the task sleeps)
+    ResetMarbles();
+    physics_enter();
 }
 
 void bounce_leave()
@@ -87,17 +77,17 @@ void bounce_loop()
         };
 
         // Draw marbles at their current positions
-        FastLED.clear();
+        const physics_snapshot_t *snapshot = physics_snapshot();
+        dl_clear(LAYER_MARBLES);
         for (int i = 0; i < MARBLE_COUNT; ++i)
         {
-            if (!b2Body_IsValid(marbles[i]))
+            b2Vec2 position;
+            if (!physics_position(snapshot, marbles[i], position))
                 continue;
 
-            b2Vec2 position = b2Body_GetPosition(marbles[i]);
-            int gx = (int)lroundf(position.x);
-            int gy = HEIGHT - (int)lroundf(position.y);
-            leds[XY(gx, gy)] = colors[i % (sizeof(colors) / sizeof(colors[0]))];
+            dl_marble(LAYER_MARBLES, position.x, HEIGHT - position.y, colors[i % (sizeof(colors) / sizeof(colors[0]))]);
         }
+        dl_render();
 
         leds_dirty = true;
     }
@@ -108,11 +98,6 @@ void bounce_loop()
         //        DB_PRINTF("Free heap: %u bytes | Largest block: %u bytes\r\n", heap_caps_get_free_size(MALLOC_CAP_8BIT), heap_caps_get_largest_free_block(MALLOC_CAP_8BIT));
         //        DB_PRINTF("Physics stack high watermark: %d bytes\r\n", uxTaskGetStackHighWaterMark(physicsTaskHandle));
 
-        // make sure we can get the world mutex before resetting the world
-        if (xSemaphoreTake(worldMutex, portMAX_DELAY))
-        {
-            ResetMarbles();
-            xSemaphoreGive(worldMutex);
-        }
+        ResetMarbles();
     }
 }
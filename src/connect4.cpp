@@ -2,6 +2,7 @@
 #include "debug.h"
 #include "render.h"
 #include "physics.h"
+#include "displaylist.h"
 #include "connect4.h"
 #include "settings.h"
 #include "RealTimeClock.h"
@@ -13,6 +14,8 @@
 static bool clockColors[MARBLE_COUNT];
 static b2BodyId marbles[MARBLE_COUNT];
 static b2BodyId floorId;
+static bool floorUp = false;
+static uint32_t floorCommand = 0; // the command that last created or destroyed the floor
 
 // position the marbles to show the current time
 static void ResetMarbles()
@@ -23,19 +26,10 @@ static void ResetMarbles()
         for (int c = 0; c < CLOCK_WIDTH; ++c)
         {
             int index = r * CLOCK_WIDTH + c;
-#ifdef DEBUG
-            if (!b2Body_IsValid(marbles[index]))
-            {
-                DB_PRINTF("Invalid marble at index %d at %s:%d\n", index, __FILE__, __LINE__);
-                continue;
-            }
-#endif // DEBUG
             b2Vec2 position = b2Vec2{(float)c, (float)(NUM_ROWS + r + 1)};
-            b2Rot rotation = b2MakeRot(0.0f);
-            b2Body_SetTransform(marbles[index], position, rotation); // Move to new location
+            physics_set_transform(marbles[index], position); // Move to new location
             float vy = (random(-100, 0)) / 50.0f;
-            b2Body_SetLinearVelocity(marbles[index], (b2Vec2){0, vy});
-            b2Body_SetAngularVelocity(marbles[index], 0.0f); // Stop spin
+            physics_set_velocity(marbles[index], (b2Vec2){0, vy}); // and stop any spin
         }
     }
 
@@ -55,10 +49,8 @@ static void ResetMarbles()
 
 static void setupWorld()
 {
-    // create the world
-    b2WorldDef worldDef = b2DefaultWorldDef();
-    worldDef.gravity = (b2Vec2){0.0f, -9.8f};
-    world = b2CreateWorld(&worldDef);
+    // get the (reused) world ready
+    physics_reset((b2Vec2){0.0f, -9.8f});
 
     if (B2_IS_NULL(world))
     {
@@ -69,6 +61,8 @@ static void setupWorld()
     // create a floor that we will remove as needed to let marbles fall
     int startY = (NUM_ROWS - CLOCK_HEIGHT) / 2;
     floorId = CreateLine(0, startY, NUM_COLS, startY);
+    floorUp = true;
+    floorCommand = 0;
 
     // create walls to create columns
     for (int c = 0; c <= NUM_COLS; ++c)
@@ -94,17 +88,11 @@ void connect4_enter()
     // Initializie physics world and start physics task
     DB_PRINTLN("Entering Connect4 mode");
     setupWorld();
-    physics_enter();
 
-    // Small delay to ensure physics task is running
-    vTaskDelay(pdMS_TO_TICKS(100));
-
-    // position the marbles to show the current time (after physics task is running)
-    if (xSemaphoreTake(worldMutex, portMAX_DELAY))
-    {
-        ResetMarbles();
-        xSemaphoreGive(worldMutex);
-    }
+    // position the marbles to show the current time before waking the task so its first
+    // step already has them (the queue takes commands while the task sleeps)
+    ResetMarbles();
+    physics_enter();
 }
 
 void connect4_leave()
@@ -119,28 +107,40 @@ void connect4_loop()
     EVERY_N_MILLIS(16)
     {
         // Draw marbles at their current positions
-        FastLED.clear();
+        const physics_snapshot_t *snapshot = physics_snapshot();
+        dl_clear(LAYER_MARBLES);
         for (int i = 0; i < MARBLE_COUNT; ++i)
         {
-#ifdef DEBUG
-            if (!b2Body_IsValid(marbles[i]))
-            {
-                DB_PRINTF("Invalid marble at index %d at %s:%d\n", i, __FILE__, __LINE__);
+            // the black marbles are just there to hold the others in place
+            if (!clockColors[i])
+                continue;
+
+            // Center the clock in the LED display
+            b2Vec2 position;
+            if (!physics_position(snapshot, marbles[i], position))
                 continue;
+            float x = (NUM_COLS - CLOCK_WIDTH) / 2 + position.x;
+            float y = NUM_ROWS - position.y;
+
+            // marbles that have come to rest snap to their LED so the digits are crisp
+            if (!physics_awake(snapshot, marbles[i]))
+            {
+                x = lroundf(x);
+                y = lroundf(y);
             }
-#endif // DEBUG
-       // Center the clock in the LED display
-            b2Vec2 position = b2Body_GetPosition(marbles[i]);
-            int gx = (NUM_COLS - CLOCK_WIDTH) / 2 + (int)lroundf(position.x);
-            int gy = NUM_ROWS - (int)lroundf(position.y);
-            leds[XY(gx, gy)] = clockColors[i] ? settings.clockColor : CRGB::Black;
+            dl_marble(LAYER_MARBLES, x, y, settings.clockColor);
         }
+        dl_render();
 
         leds_dirty = true;
     }
 
+    // wait until the last change to the floor has been made
+    if (!physics_done(floorCommand))
+        return;
+
     // if the floor is in place, check if we need to remove it to let the marbles fall
-    if (b2Body_IsValid(floorId))
+    if (floorUp)
     {
         // reset marble positions every time the minute changes
         static int lastMinute = -1;
@@ -149,25 +149,19 @@ void connect4_loop()
         {
             int currentMinute = timeinfo.tm_min;
 
-            if (currentMinute != lastMinute)
+            // remove the floor to let marbles fall (if the queue is full, try again next loop)
+            uint32_t command;
+            if (currentMinute != lastMinute && (command = physics_destroy_body(floorId)))
             {
                 lastMinute = currentMinute;
+                floorCommand = command;
+                floorUp = false;
 
-                // make sure we can get the world mutex before changing the world
-                if (xSemaphoreTake(worldMutex, portMAX_DELAY))
+                // give each marble a small downward velocity to start them falling
+                for (int i = 0; i < MARBLE_COUNT; ++i)
                 {
-                    // remove the floor to let marbles fall
-                    b2DestroyBody(floorId);
-                    floorId = B2_NULL_ID;
-
-                    // give each marble a small downward velocity to start them falling
-                    for (int i = 0; i < MARBLE_COUNT; ++i)
-                    {
-                        float vy = (random(-100, 0)) / 50.0f;
-                        b2Body_SetLinearVelocity(marbles[i], (b2Vec2){0, vy});
-                    }
-
-                    xSemaphoreGive(worldMutex);
+                    float vy = (random(-100, 0)) / 50.0f;
+                    physics_set_velocity(marbles[i], (b2Vec2){0, vy});
                 }
             }
         }
@@ -175,17 +169,16 @@ void connect4_loop()
     else
     {
         // check to see if all marbles are below the visible area
+        const physics_snapshot_t *snapshot = physics_snapshot();
         bool allBelow = true;
         for (int i = 0; i < MARBLE_COUNT; ++i)
         {
-#ifdef DEBUG
-            if (!b2Body_IsValid(marbles[i]))
+            b2Vec2 position;
+            if (!physics_position(snapshot, marbles[i], position))
             {
-                DB_PRINTF("Invalid marble at index %d at %s:%d\n", i, __FILE__, __LINE__);
+                DB_PRINTF("Marble %d isn't in the physics snapshot at %s:%d\n", i, __FILE__, __LINE__);
                 continue;
             }
-#endif // DEBUG
-            b2Vec2 position = b2Body_GetPosition(marbles[i]);
             if (lroundf(position.y) >= 0)
             {
                 allBelow = false;
@@ -195,15 +188,15 @@ void connect4_loop()
 
         if (allBelow)
         {
-            // make sure we can get the world mutex before recreating the floor
-            if (xSemaphoreTake(worldMutex, portMAX_DELAY))
+            // recreate the floor (if the queue is full, try again next loop)
+            int startY = (NUM_ROWS - CLOCK_HEIGHT) / 2;
+            uint32_t command = physics_create_line(&floorId, (b2Vec2){0.0f, (float)startY}, (b2Vec2){(float)NUM_COLS, (float)startY});
+            if (command)
             {
-                // recreate the floor
-                int startY = (NUM_ROWS - CLOCK_HEIGHT) / 2;
-                floorId = CreateLine(0, startY, NUM_COLS, startY);
+                floorCommand = command;
+                floorUp = true;
 
                 ResetMarbles();
-                xSemaphoreGive(worldMutex);
             }
         }
     }
@@ -0,0 +1,346 @@
+#include "main.h"
+#include "debug.h"
+#include "render.h"
+#include "pixelops.h"
+#include "splat.h"
+#include "displaynumbers.h"
+#include "displaylist.h"
+
+// https://wokwi.com/arduino/projects/286985034843292172
+#include "wuLineAA.h"
+
+typedef enum
+{
+    DL_OP_FILL,
+    DL_OP_SPAN, // points are one LED spans
+    DL_OP_CIRCLE,
+    DL_OP_GLYPH,
+    DL_OP_LINE,
+    DL_OP_MARBLE,
+} DL_OP;
+
+typedef struct
+{
+    uint8_t op;
+    uint8_t mode;
+    int16_t x, y;   // position (8.8 fixed point for lines and marbles)
+    int16_t x2, y2; // line end point, span length (x2), circle radius (x2) or glyph (x2)
+    CRGB color;
+} dl_command_t;
+
+typedef struct
+{
+    dl_command_t *commands;
+    uint16_t capacity;
+    uint16_t count;
+    uint32_t version; // changes whenever the layer does
+} dl_layer_t;
+
+static dl_command_t backgroundCommands[128];
+static dl_command_t marbleCommands[128];
+static dl_command_t textCommands[32];
+static dl_command_t clockCommands[32];
+
+#define LAYER(commands) {commands, sizeof(commands) / sizeof(commands[0]), 0, 0}
+static dl_layer_t layers[NUM_LAYERS] = {
+    LAYER(backgroundCommands),
+    LAYER(marbleCommands),
+    LAYER(textCommands),
+    LAYER(clockCommands)};
+
+// the background layer rasterized on black, copied into leds[] by dl_render() (with a hidden pixel for wuLineAA)
+static CRGB backgroundFrame[NUM_LEDS + 1];
+static uint32_t backgroundVersion = UINT32_MAX;
+static uint32_t marblesVersion = UINT32_MAX;
+
+// leds[] with the overlays on top (with a hidden pixel for wuLineAA)
+static CRGB presentFrame[NUM_LEDS + 1];
+
+void dl_clear(DL_LAYER layer)
+{
+    layers[layer].count = 0;
+    layers[layer].version++;
+}
+
+void dl_reset()
+{
+    dl_clear(LAYER_BACKGROUND);
+    dl_clear(LAYER_MARBLES);
+    dl_clear(LAYER_TEXT);
+}
+
+static dl_command_t *add_command(DL_LAYER layer, DL_OP op, DL_MODE mode, const CRGB &color)
+{
+    dl_layer_t &l = layers[layer];
+    if (l.count >= l.capacity)
+    {
+        DB_PRINTF("Display list layer %d is full\r\n", layer);
+        return NULL;
+    }
+
+    dl_command_t *command = &l.commands[l.count++];
+    command->op = op;
+    command->mode = mode;
+    command->color = color;
+    l.version++;
+    return command;
+}
+
+void dl_fill(DL_LAYER layer, const CRGB &color, DL_MODE mode)
+{
+    add_command(layer, DL_OP_FILL, mode, color);
+}
+
+void dl_point(DL_LAYER layer, int16_t x, int16_t y, const CRGB &color, DL_MODE mode)
+{
+    dl_span(layer, x, y, 1, color, mode);
+}
+
+void dl_span(DL_LAYER layer, int16_t x, int16_t y, int16_t length, const CRGB &color, DL_MODE mode)
+{
+    // grow the last span instead if this one carries straight on from it
+    dl_layer_t &l = layers[layer];
+    if (l.count)
+    {
+        dl_command_t &last = l.commands[l.count - 1];
+        if (last.op == DL_OP_SPAN && last.mode == mode && last.y == y && last.x + last.x2 == x && last.color == color)
+        {
+            last.x2 += length;
+            l.version++;
+            return;
+        }
+    }
+
+    dl_command_t *command = add_command(layer, DL_OP_SPAN, mode, color);
+    if (command)
+    {
+        command->x = x;
+        command->y = y;
+        command->x2 = length;
+    }
+}
+
+void dl_circle(DL_LAYER layer, int16_t x, int16_t y, int16_t radius, const CRGB &color, DL_MODE mode)
+{
+    dl_command_t *command = add_command(layer, DL_OP_CIRCLE, mode, color);
+    if (command)
+    {
+        command->x = x;
+        command->y = y;
+        command->x2 = radius;
+    }
+}
+
+void dl_glyph(DL_LAYER layer, uint8_t glyph, int16_t x, int16_t y, const CRGB &color, DL_MODE mode)
+{
+    if (glyph >= GLYPH_COUNT)
+        return;
+
+    dl_command_t *command = add_command(layer, DL_OP_GLYPH, mode, color);
+    if (command)
+    {
+        command->x = x;
+        command->y = y;
+        command->x2 = glyph;
+    }
+}
+
+void dl_line(DL_LAYER layer, int16_t x1, int16_t y1, int16_t x2, int16_t y2, const CRGB &color)
+{
+    dl_command_t *command = add_command(layer, DL_OP_LINE, DL_BLEND, color);
+    if (command)
+    {
+        command->x = x1;
+        command->y = y1;
+        command->x2 = x2;
+        command->y2 = y2;
+    }
+}
+
+void dl_marble(DL_LAYER layer, float x, float y, const CRGB &color)
+{
+    // a marble only touches the LEDs within one of its center, drop the ones that are
+    // off the panel before they overflow the 8.8 fixed point coordinates and wrap back on
+    if (!(x > -1.0f && x < NUM_COLS && y > -1.0f && y < NUM_ROWS))
+        return;
+
+    dl_command_t *command = add_command(layer, DL_OP_MARBLE, DL_ADD, color);
+    if (command)
+    {
+        command->x = lroundf(x * 256);
+        command->y = lroundf(y * 256);
+    }
+}
+
+// ----- rasterizer -----
+
+static inline void plot(CRGB *frame, uint16_t x, uint16_t y, const CRGB &color, uint8_t mode)
+{
+    // negative values wrap to large unsigned values
+    if (x >= NUM_COLS || y >= NUM_ROWS)
+        return;
+
+    CRGB &led = frame[y * NUM_COLS + x];
+    switch (mode)
+    {
+    case DL_REPLACE:
+        led = color;
+        break;
+    case DL_BLEND:
+        led = blend(led, color, 128);
+        break;
+    case DL_ADD:
+        led += color;
+        break;
+    }
+}
+
+static void draw_span(CRGB *frame, int16_t x, int16_t y, int16_t length, const CRGB &color, uint8_t mode)
+{
+    if (y < 0 || y >= NUM_ROWS)
+        return;
+
+    // clip to the row
+    int16_t end = x + length;
+    if (x < 0)
+        x = 0;
+    if (end > NUM_COLS)
+        end = NUM_COLS;
+    if (x >= end)
+        return;
+
+    if (mode == DL_REPLACE)
+    {
+        pixels_fill(&frame[y * NUM_COLS + x], end - x, color);
+    }
+    else
+    {
+        for (; x < end; x++)
+        {
+            plot(frame, x, y, color, mode);
+        }
+    }
+}
+
+static void rasterize(const dl_layer_t &layer, CRGB *frame)
+{
+    // consecutive marbles are drawn in one batch
+    splat_t batch[16];
+    int batched = 0;
+
+    for (uint16_t i = 0; i < layer.count; i++)
+    {
+        const dl_command_t &command = layer.commands[i];
+
+        if (command.op == DL_OP_MARBLE)
+        {
+            batch[batched++] = {command.x / 256.0f, command.y / 256.0f, command.color};
+            if (batched == sizeof(batch) / sizeof(batch[0]))
+            {
+                splat_marbles(frame, batch, batched);
+                batched = 0;
+            }
+            continue;
+        }
+        if (batched)
+        {
+            splat_marbles(frame, batch, batched);
+            batched = 0;
+        }
+
+        switch (command.op)
+        {
+        case DL_OP_FILL:
+            if (command.mode == DL_REPLACE)
+            {
+                pixels_fill(frame, NUM_LEDS, command.color);
+            }
+            else
+            {
+                for (int16_t y = 0; y < NUM_ROWS; y++)
+                {
+                    draw_span(frame, 0, y, NUM_COLS, command.color, command.mode);
+                }
+            }
+            break;
+
+        case DL_OP_SPAN:
+            draw_span(frame, command.x, command.y, command.x2, command.color, command.mode);
+            break;
+
+        case DL_OP_CIRCLE:
+        {
+            // one span per row of the disc
+            int16_t r = command.x2;
+            for (int16_t dy = -r; dy <= r; dy++)
+            {
+                int16_t dx = 0;
+                while ((dx + 1) * (dx + 1) + dy * dy <= r * r + r)
+                {
+                    dx++;
+                }
+                draw_span(frame, command.x - dx, command.y + dy, 2 * dx + 1, command.color, command.mode);
+            }
+            break;
+        }
+
+        case DL_OP_GLYPH:
+            for (int16_t col = 0; col < 3; col++)
+            {
+                uint8_t bits = FONT3x5[command.x2][col];
+                for (int16_t row = 0; row < 5; row++)
+                {
+                    if (bits & (1 << row))
+                    {
+                        plot(frame, command.x + col, command.y + row, command.color, command.mode);
+                    }
+                }
+            }
+            break;
+
+        case DL_OP_LINE:
+        {
+            CRGB color = command.color;
+            wuLineAA(frame, command.x, command.y, command.x2, command.y2, &color);
+            break;
+        }
+        }
+    }
+
+    if (batched)
+    {
+        splat_marbles(frame, batch, batched);
+    }
+}
+
+void dl_render()
+{
+    const dl_layer_t &background = layers[LAYER_BACKGROUND];
+    const dl_layer_t &marbles = layers[LAYER_MARBLES];
+
+    // skip the layers that haven't changed
+    if (background.version == backgroundVersion && marbles.version == marblesVersion)
+        return;
+
+    if (background.version != backgroundVersion)
+    {
+        memset(backgroundFrame, 0, sizeof(backgroundFrame));
+        rasterize(background, backgroundFrame);
+        backgroundVersion = background.version;
+    }
+
+    memcpy(leds, backgroundFrame, sizeof(CRGB) * NUM_LEDS);
+    rasterize(marbles, leds);
+    marblesVersion = marbles.version;
+}
+
+const CRGB *dl_present(const CRGB *frame)
+{
+    if (!layers[LAYER_TEXT].count && !layers[LAYER_CLOCK].count)
+        return frame;
+
+    memcpy(presentFrame, frame, sizeof(CRGB) * NUM_LEDS);
+    rasterize(layers[LAYER_TEXT], presentFrame);
+    rasterize(layers[LAYER_CLOCK], presentFrame);
+    return presentFrame;
+}
@@ -0,0 +1,64 @@
+#ifndef DISPLAYLIST_H
+#define DISPLAYLIST_H
+
+#include "render.h" // for CRGB
+
+//
+// Retained display list. Rather than clearing the frame and writing pixels, modes (and
+// the clock) describe what they want drawn as a list of primitives on a layer. A layer
+// keeps its primitives until it is cleared, so static scenery is only described once
+// and layers that haven't changed aren't redrawn.
+//
+// The mode layers are rasterized into leds[] by dl_render(). The overlay layers are
+// composited over whatever render_show() is about to display, so the clock never ends
+// up in the frame buffer (where trail effects would fade it) and stays put during
+// transitions.
+//
+
+typedef enum
+{
+    LAYER_BACKGROUND, // static scenery (pins, tracks), rasterized once and cached
+    LAYER_MARBLES,    // things that move, normally rebuilt every frame
+    LAYER_TEXT,       // overlay owned by the mode (e.g. life's generation counter)
+    LAYER_CLOCK,      // overlay owned by the clock face
+    NUM_LAYERS
+} DL_LAYER;
+
+// how a primitive combines with the pixels underneath it
+typedef enum
+{
+    DL_REPLACE, // the pixel becomes the color
+    DL_BLEND,   // 50/50 blend of the pixel and the color
+    DL_ADD,     // saturating add
+} DL_MODE;
+
+// start over on a layer (empties it)
+void dl_clear(DL_LAYER layer);
+
+// empty every layer except the clock (the mode is changing)
+void dl_reset();
+
+// primitives. Coordinates are LEDs with (0, 0) at the top left unless noted otherwise
+// and anything outside the frame is clipped.
+void dl_fill(DL_LAYER layer, const CRGB &color, DL_MODE mode = DL_REPLACE);
+void dl_point(DL_LAYER layer, int16_t x, int16_t y, const CRGB &color, DL_MODE mode = DL_REPLACE);
+void dl_span(DL_LAYER layer, int16_t x, int16_t y, int16_t length, const CRGB &color, DL_MODE mode = DL_REPLACE);
+void dl_circle(DL_LAYER layer, int16_t x, int16_t y, int16_t radius, const CRGB &color, DL_MODE mode = DL_REPLACE);
+
+// a glyph from the 3x5 font (see displaynumbers.h) with its top left corner at (x, y)
+void dl_glyph(DL_LAYER layer, uint8_t glyph, int16_t x, int16_t y, const CRGB &color, DL_MODE mode = DL_REPLACE);
+
+// an antialiased line between two points in 8.8 fixed point LED coordinates
+void dl_line(DL_LAYER layer, int16_t x1, int16_t y1, int16_t x2, int16_t y2, const CRGB &color);
+
+// an antialiased marble centered on (x, y), added to what is underneath (see splat.h)
+void dl_marble(DL_LAYER layer, float x, float y, const CRGB &color);
+
+// rasterize the background and marble layers into leds[] (leaves leds[] alone if
+// neither has changed since the last call)
+void dl_render();
+
+// composite the overlay layers on top of frame, returns the frame to display
+const CRGB *dl_present(const CRGB *frame);
+
+#endif // DISPLAYLIST_H
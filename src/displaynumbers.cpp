@@ -3,8 +3,8 @@
 #include "render.h"
 #include "displaynumbers.h"
 
-// 3x5 font for digits 0-9
-static const uint8_t FONT3x5[10][3] = {
+// 3x5 font for digits 0-9 and ':'
+const uint8_t FONT3x5[GLYPH_COUNT][3] = {
     // Each entry = 3 columns; bits 0..4 = rows top..bottom
     {0x1F, 0x11, 0x1F}, // 0
     {0x00, 0x00, 0x1F}, // 1
@@ -15,7 +15,8 @@ static const uint8_t FONT3x5[10][3] = {
     {0x1F, 0x15, 0x1D}, // 6
     {0x01, 0x01, 0x1F}, // 7
     {0x1F, 0x15, 0x1F}, // 8
-    {0x17, 0x15, 0x1F}  // 9
+    {0x17, 0x15, 0x1F}, // 9
+    {0x0A, 0x00, 0x00}  // :
 };
 
 void drawDigit3x5(int digit, int xOffset, int yOffset, setLEDFunction setLED)
@@ -36,8 +37,14 @@ void drawDigit3x5(int digit, int xOffset, int yOffset, setLEDFunction setLED)
 void drawColon1x5(int xOffset, int yOffset, setLEDFunction setLED)
 {
     // Dots at rows 1 and 3 within the 5-row block
-    setLED(xOffset, yOffset + 1);
-    setLED(xOffset, yOffset + 3);
+    uint8_t bits = FONT3x5[GLYPH_COLON][0];
+    for (int row = 0; row < 5; ++row)
+    {
+        if (bits & (1 << row))
+        {
+            setLED(xOffset, yOffset + row);
+        }
+    }
 }
 
 void drawTime17x5(int n1, int n2, int n3, int n4, int xOffset, int yOffset, setLEDFunction setLED)
@@ -68,3 +75,31 @@ void drawTime17x5(int n1, int n2, int n3, int n4, int xOffset, int yOffset, setL
     drawDigit3x5(n3, x, yOffset, setLED); x += 3; x += 1;
     drawDigit3x5(n4, x, yOffset, setLED);
 }
+
+void drawDigit3x5(int digit, int xOffset, int yOffset, DL_LAYER layer, const CRGB &color, DL_MODE mode)
+{
+    dl_glyph(layer, digit, xOffset, yOffset, color, mode);
+}
+
+void drawTime17x5(int n1, int n2, int n3, int n4, int xOffset, int yOffset, DL_LAYER layer, const CRGB &color, DL_MODE mode)
+{
+#ifdef DEBUG
+    // do some sanity checking
+    if (n1 < 0 || n1 > 9 || n2 < 0 || n2 > 9 || n3 < 0 || n3 > 9 || n4 < 0 || n4 > 9)
+    {
+        DB_PRINTF("\rdrawTime called with number that is out of range (0-9): %d, %d, %d, %d\r\n", n1, n2, n3, n4);
+        return;
+    }
+#endif
+    // HH : MM with single-column spaces and colon
+    int x = xOffset;
+    if (n1)
+    {
+        dl_glyph(layer, n1, x, yOffset, color, mode);
+    }
+    x += 3; x += 1;
+    dl_glyph(layer, n2, x, yOffset, color, mode); x += 3; x += 1;
+    dl_glyph(layer, GLYPH_COLON, x, yOffset, color, mode); x += 1; x += 1;
+    dl_glyph(layer, n3, x, yOffset, color, mode); x += 3; x += 1;
+    dl_glyph(layer, n4, x, yOffset, color, mode);
+}
@@ -1,8 +1,20 @@
 #ifndef DISPLAY_NUMBERS_H
 #define DISPLAY_NUMBERS_H
 
+#include "displaylist.h"
+
+// 3x5 font: glyphs 0-9 are the digits and GLYPH_COLON is ':'. Each entry is 3 columns;
+// bits 0..4 = rows top..bottom
+#define GLYPH_COLON 10
+#define GLYPH_COUNT 11
+extern const uint8_t FONT3x5[GLYPH_COUNT][3];
+
 void drawColon1x5(int xOffset, int yOffset, setLEDFunction setLED);
 void drawDigit3x5(int digit, int xOffset, int yOffset, setLEDFunction setLED);
 void drawTime17x5(int n1, int n2, int n3, int n4, int xOffset, int yOffset, setLEDFunction setLED);
 
+// the same, as glyphs on a display list layer
+void drawDigit3x5(int digit, int xOffset, int yOffset, DL_LAYER layer, const CRGB &color, DL_MODE mode = DL_BLEND);
+void drawTime17x5(int n1, int n2, int n3, int n4, int xOffset, int yOffset, DL_LAYER layer, const CRGB &color, DL_MODE mode = DL_BLEND);
+
 #endif // DISPLAY_NUMBERS_H
@@ -0,0 +1,470 @@
+#include "main.h"
+#include "debug.h"
+#include "hashlife.h"
+
+//
+// Nodes are kept in one array and refer to each other by index. Level 0 nodes are the
+// two cells (dead and alive), a level k node is a 2^k square made of four level k - 1
+// quadrants. Every node is unique (see hl_join()) so equal squares are the same index
+// and the successor memoized for one is shared by all of its copies.
+//
+// When the array fills up the nodes that can't be reached from the root are collected
+// and the step is run again.
+//
+
+#define HL_DEAD 0
+#define HL_ALIVE 1
+#define HL_MAX_LEVEL 30 // the universe is at most 2^30 cells across (bounds the recursion)
+
+enum
+{
+    NW,
+    NE,
+    SW,
+    SE
+};
+
+typedef struct
+{
+    uint32_t child[4];   // quadrants (NW, NE, SW, SE)
+    uint32_t next;       // next node in the hash chain (or the free list)
+    uint32_t result;     // memoized successor for the current step size, 0 if not known yet
+    uint32_t population; // live cells (saturates)
+    uint8_t level;
+    bool marked; // reachable (garbage collection)
+} hl_node_t;
+
+struct hashlife_t
+{
+    hl_node_t *nodes;
+    uint32_t capacity;
+    uint32_t top;      // nodes[top...] have never been used
+    uint32_t freeList; // nodes collected by hl_collect()
+    uint32_t *buckets;
+    uint32_t bucketMask;
+    bool overflow; // ran out of nodes during this step
+
+    uint32_t empty[HL_MAX_LEVEL + 1]; // the empty square of each level
+    uint32_t root;
+    int64_t originX, originY; // top left corner of the root
+    int stepLog2;             // step size the memoized results are for
+
+    uint16_t birth, survival;
+};
+
+static inline uint32_t hl_hash(uint32_t nw, uint32_t ne, uint32_t sw, uint32_t se)
+{
+    uint32_t h = nw * 0x9E3779B1u + ne * 0x85EBCA77u + sw * 0xC2B2AE3Du + se * 0x27D4EB2Fu;
+    return h ^ (h >> 15);
+}
+
+// the unique node with these quadrants (an empty node of the right level if out of nodes)
+static uint32_t hl_join(hashlife_t *u, uint32_t nw, uint32_t ne, uint32_t sw, uint32_t se)
+{
+    uint8_t level = u->nodes[nw].level + 1;
+    uint32_t *bucket = &u->buckets[hl_hash(nw, ne, sw, se) & u->bucketMask];
+    for (uint32_t i = *bucket; i; i = u->nodes[i].next)
+    {
+        const hl_node_t &n = u->nodes[i];
+        if (n.child[NW] == nw && n.child[NE] == ne && n.child[SW] == sw && n.child[SE] == se)
+            return i;
+    }
+
+    uint32_t i;
+    if (u->freeList)
+    {
+        i = u->freeList;
+        u->freeList = u->nodes[i].next;
+    }
+    else if (u->top < u->capacity)
+    {
+        i = u->top++;
+    }
+    else
+    {
+        u->overflow = true;
+        return u->empty[level];
+    }
+
+    hl_node_t &n = u->nodes[i];
+    n.child[NW] = nw;
+    n.child[NE] = ne;
+    n.child[SW] = sw;
+    n.child[SE] = se;
+    uint64_t population = (uint64_t)u->nodes[nw].population + u->nodes[ne].population + u->nodes[sw].population + u->nodes[se].population;
+    n.population = population > UINT32_MAX ? UINT32_MAX : population;
+    n.level = level;
+    n.result = 0;
+    n.marked = false;
+    n.next = *bucket;
+    *bucket = i;
+    return i;
+}
+
+static inline uint32_t hl_child(const hashlife_t *u, uint32_t node, int quadrant)
+{
+    return u->nodes[node].child[quadrant];
+}
+
+// the same square in the middle of one twice its size
+static uint32_t hl_centre(hashlife_t *u, uint32_t node)
+{
+    uint32_t e = u->empty[u->nodes[node].level - 1];
+    return hl_join(u,
+                   hl_join(u, e, e, e, hl_child(u, node, NW)),
+                   hl_join(u, e, e, hl_child(u, node, NE), e),
+                   hl_join(u, e, hl_child(u, node, SW), e, e),
+                   hl_join(u, hl_child(u, node, SE), e, e, e));
+}
+
+// true if all the live cells are in the middle half of the node (needs level 2 or more)
+static bool hl_padded(const hashlife_t *u, uint32_t node)
+{
+    uint32_t nw = hl_child(u, node, NW), ne = hl_child(u, node, NE);
+    uint32_t sw = hl_child(u, node, SW), se = hl_child(u, node, SE);
+    uint64_t inner = (uint64_t)u->nodes[hl_child(u, nw, SE)].population + u->nodes[hl_child(u, ne, SW)].population +
+                     u->nodes[hl_child(u, sw, NE)].population + u->nodes[hl_child(u, se, NW)].population;
+    return inner == u->nodes[node].population;
+}
+
+// one generation of the middle 2x2 of a 4x4 node by brute force
+static uint32_t hl_life4x4(hashlife_t *u, uint32_t node)
+{
+    // bit y * 4 + x is the cell (x, y)
+    uint16_t cells = 0;
+    for (int q = 0; q < 4; q++)
+    {
+        uint32_t quadrant = hl_child(u, node, q);
+        for (int c = 0; c < 4; c++)
+        {
+            if (hl_child(u, quadrant, c) == HL_ALIVE)
+            {
+                int x = (q & 1) * 2 + (c & 1);
+                int y = (q >> 1) * 2 + (c >> 1);
+                cells |= 1 << (y * 4 + x);
+            }
+        }
+    }
+
+    uint32_t result[4];
+    for (int c = 0; c < 4; c++)
+    {
+        int x = 1 + (c & 1), y = 1 + (c >> 1);
+        int neighbors = 0;
+        for (int dy = -1; dy <= 1; dy++)
+            for (int dx = -1; dx <= 1; dx++)
+                if (dx || dy)
+                    neighbors += (cells >> ((y + dy) * 4 + x + dx)) & 1;
+        bool alive = (cells >> (y * 4 + x)) & 1;
+        result[c] = ((alive ? u->survival : u->birth) >> neighbors) & 1 ? HL_ALIVE : HL_DEAD;
+    }
+    return hl_join(u, result[NW], result[NE], result[SW], result[SE]);
+}
+
+// The middle half of a level k node advanced 2^min(stepLog2, k - 2) generations
+static uint32_t hl_successor(hashlife_t *u, uint32_t node)
+{
+    const hl_node_t &n = u->nodes[node];
+    uint8_t level = n.level;
+    if (!n.population)
+        return u->empty[level - 1];
+    if (n.result)
+        return n.result;
+
+    uint32_t result;
+    if (level == 2)
+    {
+        result = hl_life4x4(u, node);
+    }
+    else
+    {
+        uint32_t a = n.child[NW], b = n.child[NE], c = n.child[SW], d = n.child[SE];
+
+        // the nine overlapping quadrant sized squares, each advanced once
+        uint32_t c1 = hl_successor(u, a);
+        uint32_t c2 = hl_successor(u, hl_join(u, hl_child(u, a, NE), hl_child(u, b, NW), hl_child(u, a, SE), hl_child(u, b, SW)));
+        uint32_t c3 = hl_successor(u, b);
+        uint32_t c4 = hl_successor(u, hl_join(u, hl_child(u, a, SW), hl_child(u, a, SE), hl_child(u, c, NW), hl_child(u, c, NE)));
+        uint32_t c5 = hl_successor(u, hl_join(u, hl_child(u, a, SE), hl_child(u, b, SW), hl_child(u, c, NE), hl_child(u, d, NW)));
+        uint32_t c6 = hl_successor(u, hl_join(u, hl_child(u, b, SW), hl_child(u, b, SE), hl_child(u, d, NW), hl_child(u, d, NE)));
+        uint32_t c7 = hl_successor(u, c);
+        uint32_t c8 = hl_successor(u, hl_join(u, hl_child(u, c, NE), hl_child(u, d, NW), hl_child(u, c, SE), hl_child(u, d, SW)));
+        uint32_t c9 = hl_successor(u, d);
+
+        if (u->stepLog2 < level - 2)
+        {
+            // a short step: the middles of the four overlapping squares of the nine
+            result = hl_join(u,
+                             hl_join(u, hl_child(u, c1, SE), hl_child(u, c2, SW), hl_child(u, c4, NE), hl_child(u, c5, NW)),
+                             hl_join(u, hl_child(u, c2, SE), hl_child(u, c3, SW), hl_child(u, c5, NE), hl_child(u, c6, NW)),
+                             hl_join(u, hl_child(u, c4, SE), hl_child(u, c5, SW), hl_child(u, c7, NE), hl_child(u, c8, NW)),
+                             hl_join(u, hl_child(u, c5, SE), hl_child(u, c6, SW), hl_child(u, c8, NE), hl_child(u, c9, NW)));
+        }
+        else
+        {
+            // the full step: advance the four overlapping squares of the nine again
+            result = hl_join(u,
+                             hl_successor(u, hl_join(u, c1, c2, c4, c5)),
+                             hl_successor(u, hl_join(u, c2, c3, c5, c6)),
+                             hl_successor(u, hl_join(u, c4, c5, c7, c8)),
+                             hl_successor(u, hl_join(u, c5, c6, c8, c9)));
+        }
+    }
+
+    // nodes don't move so the reference is still good, a result found after running out
+    // of nodes is wrong but is thrown away with the rest by hl_collect()
+    u->nodes[node].result = result;
+    return result;
+}
+
+static void hl_mark(hashlife_t *u, uint32_t node)
+{
+    hl_node_t &n = u->nodes[node];
+    if (n.marked || n.level == 0)
+        return;
+    n.marked = true;
+    for (int q = 0; q < 4; q++)
+        hl_mark(u, n.child[q]);
+}
+
+// Garbage collection: keep the nodes reachable from the root (and the empty squares),
+// free the rest and forget every memoized result
+static void hl_collect(hashlife_t *u)
+{
+    hl_mark(u, u->root);
+    for (int level = 1; level <= HL_MAX_LEVEL; level++)
+        hl_mark(u, u->empty[level]);
+
+    memset(u->buckets, 0, (u->bucketMask + 1) * sizeof(uint32_t));
+    u->freeList = 0;
+    for (uint32_t i = u->top - 1; i > HL_ALIVE; i--)
+    {
+        hl_node_t &n = u->nodes[i];
+        if (n.marked)
+        {
+            uint32_t *bucket = &u->buckets[hl_hash(n.child[NW], n.child[NE], n.child[SW], n.child[SE]) & u->bucketMask];
+            n.next = *bucket;
+            *bucket = i;
+            n.result = 0;
+            n.marked = false;
+        }
+        else
+        {
+            n.next = u->freeList;
+            u->freeList = i;
+        }
+    }
+    u->overflow = false;
+}
+
+hashlife_t *hashlife_create(size_t nodes)
+{
+    if (nodes < 2 * HL_MAX_LEVEL + 2)
+        return NULL;
+
+    hashlife_t *u = (hashlife_t *)malloc(sizeof(hashlife_t));
+    if (!u)
+        return NULL;
+    uint32_t buckets = 1;
+    while (buckets < nodes)
+        buckets <<= 1;
+    u->capacity = nodes;
+    u->bucketMask = buckets - 1;
+    u->nodes = (hl_node_t *)heap_caps_malloc(nodes * sizeof(hl_node_t), MALLOC_CAP_SPIRAM);
+    u->buckets = (uint32_t *)heap_caps_malloc(buckets * sizeof(uint32_t), MALLOC_CAP_SPIRAM);
+    if (!u->nodes || !u->buckets)
+    {
+        hashlife_destroy(u);
+        return NULL;
+    }
+
+    hashlife_clear(u, 1 << 3, 1 << 2 | 1 << 3);
+    return u;
+}
+
+void hashlife_destroy(hashlife_t *universe)
+{
+    if (!universe)
+        return;
+    heap_caps_free(universe->nodes);
+    heap_caps_free(universe->buckets);
+    free(universe);
+}
+
+void hashlife_clear(hashlife_t *universe, uint16_t birth, uint16_t survival)
+{
+    hashlife_t *u = universe;
+    u->birth = birth;
+    u->survival = survival;
+    u->stepLog2 = 0;
+    u->overflow = false;
+    u->freeList = 0;
+    memset(u->buckets, 0, (u->bucketMask + 1) * sizeof(uint32_t));
+
+    // the two cells
+    memset(u->nodes, 0, 2 * sizeof(hl_node_t));
+    u->nodes[HL_ALIVE].population = 1;
+    u->top = 2;
+
+    u->empty[0] = HL_DEAD;
+    for (int level = 1; level <= HL_MAX_LEVEL; level++)
+    {
+        uint32_t e = u->empty[level - 1];
+        u->empty[level] = hl_join(u, e, e, e, e);
+    }
+
+    u->root = u->empty[3];
+    u->originX = -4;
+    u->originY = -4;
+}
+
+// set the cell at (x, y) of a level node
+static uint32_t hl_set(hashlife_t *u, uint32_t node, int64_t x, int64_t y)
+{
+    const hl_node_t &n = u->nodes[node];
+    if (n.level == 0)
+        return HL_ALIVE;
+
+    int64_t half = (int64_t)1 << (n.level - 1);
+    int q = (y >= half ? 2 : 0) + (x >= half ? 1 : 0);
+    uint32_t child[4] = {n.child[NW], n.child[NE], n.child[SW], n.child[SE]};
+    child[q] = hl_set(u, child[q], x & (half - 1), y & (half - 1));
+    return hl_join(u, child[NW], child[NE], child[SW], child[SE]);
+}
+
+void hashlife_set(hashlife_t *universe, int64_t x, int64_t y)
+{
+    hashlife_t *u = universe;
+
+    // grow the universe until it holds the cell
+    while (true)
+    {
+        uint8_t level = u->nodes[u->root].level;
+        int64_t size = (int64_t)1 << level;
+        if (x >= u->originX && x < u->originX + size && y >= u->originY && y < u->originY + size)
+            break;
+        if (level >= HL_MAX_LEVEL)
+            return;
+        u->root = hl_centre(u, u->root);
+        u->originX -= size / 2;
+        u->originY -= size / 2;
+    }
+    u->root = hl_set(u, u->root, x - u->originX, y - u->originY);
+}
+
+bool hashlife_step(hashlife_t *universe, int log2)
+{
+    hashlife_t *u = universe;
+    if (log2 < 0 || log2 > HL_MAX_LEVEL - 3)
+        return false;
+
+    // the memoized results are only good for one step size
+    if (log2 != u->stepLog2)
+    {
+        for (uint32_t i = 0; i < u->top; i++)
+            u->nodes[i].result = 0;
+        u->stepLog2 = log2;
+    }
+
+    for (int attempt = 0; attempt < 2; attempt++)
+    {
+        // Make room around the pattern: the live cells need to be in the middle half of
+        // the root and the root big enough for the step, then it is doubled once more so
+        // nothing can reach the edge of the middle half (light speed is one cell per
+        // generation) that hl_successor() returns.
+        uint32_t root = u->root;
+        int64_t originX = u->originX, originY = u->originY;
+        while (u->nodes[root].level < log2 + 2 || !hl_padded(u, root))
+        {
+            if (u->nodes[root].level >= HL_MAX_LEVEL - 1)
+                return false;
+            int64_t half = (int64_t)1 << (u->nodes[root].level - 1);
+            root = hl_centre(u, root);
+            originX -= half;
+            originY -= half;
+        }
+        int64_t half = (int64_t)1 << (u->nodes[root].level - 1);
+        root = hl_centre(u, root);
+        originX -= half;
+        originY -= half;
+
+        root = hl_successor(u, root);
+        if (!u->overflow)
+        {
+            u->root = root;
+            u->originX = originX + half;
+            u->originY = originY + half;
+            return true;
+        }
+
+        // out of nodes, throw away everything but the current generation and try again
+        DB_PRINTF("hashlife: collecting %u nodes\r\n", (unsigned)u->top);
+        hl_collect(u);
+    }
+    return false;
+}
+
+uint64_t hashlife_population(const hashlife_t *universe)
+{
+    return universe->nodes[universe->root].population;
+}
+
+#define HL_FOCUS_LEVEL 5 // 32x32 blocks
+
+static void hl_focus(const hashlife_t *u, uint32_t node, int64_t x, int64_t y, uint32_t &best, int64_t &bestX, int64_t &bestY)
+{
+    // a square with fewer cells than the best block can't hold a better one
+    const hl_node_t &n = u->nodes[node];
+    if (n.population <= best)
+        return;
+
+    int64_t size = (int64_t)1 << n.level;
+    if (n.level <= HL_FOCUS_LEVEL)
+    {
+        best = n.population;
+        bestX = x + size / 2;
+        bestY = y + size / 2;
+        return;
+    }
+
+    int64_t half = size / 2;
+    hl_focus(u, n.child[NW], x, y, best, bestX, bestY);
+    hl_focus(u, n.child[NE], x + half, y, best, bestX, bestY);
+    hl_focus(u, n.child[SW], x, y + half, best, bestX, bestY);
+    hl_focus(u, n.child[SE], x + half, y + half, best, bestX, bestY);
+}
+
+bool hashlife_focus(const hashlife_t *universe, int64_t &x, int64_t &y)
+{
+    uint32_t best = 0;
+    hl_focus(universe, universe->root, universe->originX, universe->originY, best, x, y);
+    return best != 0;
+}
+
+static void hl_read(const hashlife_t *u, uint32_t node, int64_t x, int64_t y, int64_t x0, int64_t y0, size_t width, size_t height, uint32_t *rows)
+{
+    const hl_node_t &n = u->nodes[node];
+    int64_t size = (int64_t)1 << n.level;
+    if (!n.population || x >= x0 + (int64_t)width || y >= y0 + (int64_t)height || x + size <= x0 || y + size <= y0)
+        return;
+
+    if (n.level == 0)
+    {
+        rows[y - y0] |= 1u << (x - x0);
+        return;
+    }
+
+    int64_t half = size / 2;
+    hl_read(u, n.child[NW], x, y, x0, y0, width, height, rows);
+    hl_read(u, n.child[NE], x + half, y, x0, y0, width, height, rows);
+    hl_read(u, n.child[SW], x, y + half, x0, y0, width, height, rows);
+    hl_read(u, n.child[SE], x + half, y + half, x0, y0, width, height, rows);
+}
+
+void hashlife_read(const hashlife_t *universe, int64_t x0, int64_t y0, size_t width, size_t height, uint32_t *rows)
+{
+    memset(rows, 0, height * sizeof(uint32_t));
+    if (width > 32)
+        width = 32;
+    hl_read(universe, universe->root, universe->originX, universe->originY, x0, y0, width, height, rows);
+}
@@ -0,0 +1,44 @@
+#ifndef HASHLIFE_H
+#define HASHLIFE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+//
+// HashLife: an unbounded Life universe stored as a quadtree where identical squares
+// are shared (hash consed) and the future of every square is memoized, so regular
+// patterns like guns and switch engines can be run thousands of generations ahead at
+// the cost of a few. The nodes live in PSRAM. Only two state (Life-like) rules without
+// B0 are supported; the rule is given as birth and survival masks (bit n for n neighbors).
+//
+// Cells are addressed with 64 bit coordinates, y grows downward like the LED matrix.
+//
+
+typedef struct hashlife_t hashlife_t;
+
+// create an empty B3/S23 universe with room for nodes quadtree nodes, NULL if out of memory
+hashlife_t *hashlife_create(size_t nodes);
+void hashlife_destroy(hashlife_t *universe);
+
+// remove every cell and switch to a new rule
+void hashlife_clear(hashlife_t *universe, uint16_t birth, uint16_t survival);
+
+// bring the cell at (x, y) to life
+void hashlife_set(hashlife_t *universe, int64_t x, int64_t y);
+
+// advance 2^log2 generations, returns false if the universe ran out of nodes or space
+// (it is left unchanged)
+bool hashlife_step(hashlife_t *universe, int log2);
+
+// live cells in the universe
+uint64_t hashlife_population(const hashlife_t *universe);
+
+// The center of the busiest part of the universe (the 32x32 block with the most live
+// cells), false if the universe is empty
+bool hashlife_focus(const hashlife_t *universe, int64_t &x, int64_t &y);
+
+// Read the width x height window at (x0, y0) into rows (bit x of rows[y] is the cell
+// (x0 + x, y0 + y)), width is at most 32
+void hashlife_read(const hashlife_t *universe, int64_t x0, int64_t y0, size_t width, size_t height, uint32_t *rows);
+
+#endif // HASHLIFE_H
@@ -3,26 +3,69 @@
 #include "settings.h"
 #include "render.h"
 #include "life.h"
+#include "displaylist.h"
 #include "displaynumbers.h"
+#include "hashlife.h"
+#include "lifesearch.h"
 
 #define DEFAULT_MILLIS 256
 #define MIN_MILLIS 0
 #define MAX_MILLIS (4 * DEFAULT_MILLIS)
 
 //
-// Conway's Game of Life implementation
+// Game of Life implementation
 //
+// Each row of the board is a uint32_t with bit x set if cell x is alive, so a board can
+// be up to 32 cells wide and a whole row is stepped at once (see life_step()).
+//
+// Any outer totalistic rule (Life, HighLife, Day & Night, Seeds, ...) is supported as
+// well as Generations rules where a cell that dies fades through extra states before it
+// is dead. Those states are counted in binary in bit planes next to the live cells.
+//
+// A board can also be a window onto an unbounded HashLife universe (see hashlife.h) for
+// patterns that grow forever, the window follows the busiest part of the pattern.
+//
+// What is shown for each cell is a 4 bit code kept in four more bit planes (see
+// row_shade()) so it is also updated a whole row at a time.
+#define LIFE_MAX_STATES 64 // most states of a Generations rule
+#define LIFE_AGE_PLANES 6  // bits needed to count the dying states
+#define LIFE_SHADE_PLANES 4
+
+// Which neighbor counts give birth to a dead cell and let a live cell survive
 typedef struct
+{
+    uint16_t birth;    // bit n set if a dead cell with n live neighbors comes alive
+    uint16_t survival; // bit n set if a live cell with n live neighbors stays alive
+    uint8_t states;    // 2 for Life-like rules, more for Generations rules
+} life_rule_t;
+
+// B3/S23
+#define LIFE_CONWAY {1 << 3, 1 << 2 | 1 << 3, 2}
+
+struct life_t
 {
     size_t width, height;
-    size_t nbits;  // total cells
-    size_t nbytes; // bytes needed
-    uint8_t *curr; // bit-packed current generation
-    uint8_t *next; // bit-packed next generation
-    bool torus;    // wrap edges?
-} life_t;
+    size_t nbytes;  // bytes in a generation
+    uint32_t mask;  // the bits of a row that are cells
+    uint32_t *curr; // current generation, one word per row
+    uint32_t *next; // next generation, one word per row
+    life_rule_t rule;
+    size_t planes;  // bit planes of age in use (0 unless a Generations rule)
+    uint32_t *age;  // LIFE_AGE_PLANES planes of height rows, a dying cell in state s counts s - 1
+    bool torus;     // wrap edges?
+
+    uint32_t *shade; // LIFE_SHADE_PLANES planes of height rows, the display code of each cell
+    uint32_t *shown; // the shade planes as they were last drawn
+    bool repaint;    // draw every cell next time, not just the ones that changed
 
-static inline long idx_wrap(const life_t *life, long x, long y)
+    hashlife_t *universe;   // created the first time it is needed
+    bool unbounded;         // step the universe and show it through the board
+    int64_t viewX, viewY;   // top left corner of the board in the universe
+    int stepLog2;           // generations per step of the universe (log2)
+};
+
+// wrap (or reject) a cell address, returns false if the cell is off the board
+static inline bool wrap(const life_t *life, long &x, long &y)
 {
     long w = (long)life->width;
     long h = (long)life->height;
@@ -40,99 +83,201 @@ static inline long idx_wrap(const life_t *life, long x, long y)
     else
     {
         if (x < 0 || x >= w || y < 0 || y >= h)
-            return -1;
+            return false;
     }
-    return y * w + x;
+    return true;
 }
 
-// Write a cell state (0/1).
-static inline void life_set(life_t *life, size_t x, size_t y, bool v)
+// the dying cells of a row
+static inline uint32_t life_dying(const life_t *life, size_t y)
 {
-    size_t idx = y * life->width + x;
-    size_t byte = idx >> 3;
-    size_t bit = idx & 7;
-    if (v)
-        life->curr[byte] |= (1 << bit);
-    else
-        life->curr[byte] &= ~(1 << bit);
+    uint32_t dying = 0;
+    for (size_t plane = 0; plane < life->planes; ++plane)
+        dying |= life->age[plane * life->height + y];
+    return dying;
 }
 
-// Read a cell state (0/1).
+// Read a cell state (0 dead, 1 alive, 2 and up dying).
 static inline uint8_t life_get(const life_t *life, long x, long y)
 {
-    long i = idx_wrap(life, x, y);
-    if (i < 0)
+    if (!wrap(life, x, y))
         return 0; // out of bounds = dead
-    size_t idx = (size_t)i;
-    size_t byte = idx >> 3;
-    size_t bit = idx & 7;
-    return (life->curr[byte] >> bit) & 1;
+    if ((life->curr[y] >> x) & 1)
+        return 1;
+
+    uint8_t age = 0;
+    for (size_t plane = 0; plane < life->planes; ++plane)
+        age |= ((life->age[plane * life->height + y] >> x) & 1) << plane;
+    return age ? age + 1 : 0;
 }
 
-int life_load_rle(life_t *life, const char *rle, size_t x0, size_t y0)
+// Parse a rule in B/S notation ("B36/S23", "B2/S/C3" or "B2/S/3" for Generations) or
+// Golly's S/B/C notation ("23/3", "345/2/4"). It ends at a comma, newline or the end of
+// the string. Only meant to be evaluated at compile time (see life_compile_rle()).
+constexpr life_rule_t life_parse_rule(const char *rule)
 {
-    size_t x = x0, y = y0;
-    size_t run = 0;
-    int in_header = 1;
-
-    for (const char *p = rle; *p; ++p)
+    life_rule_t parsed = {0, 0, 2};
+    int field = 0;
+    bool named = false;
+    const char *p = rule;
+    while (*p && *p != ',' && *p != '\n')
     {
+        // each field is an optional letter and digits
         char c = *p;
+        if (c == 'B' || c == 'b')
+        {
+            field = 1, named = true, ++p;
+        }
+        else if (c == 'S' || c == 's')
+        {
+            field = 0, named = true, ++p;
+        }
+        else if (c == 'C' || c == 'c' || c == 'G' || c == 'g')
+        {
+            field = 2, ++p;
+        }
+
+        int states = 0;
+        while (*p >= '0' && *p <= '9')
+        {
+            if (field == 2)
+                states = states * 10 + (*p - '0');
+            else if (field == 1)
+                parsed.birth |= 1 << (*p - '0');
+            else
+                parsed.survival |= 1 << (*p - '0');
+            ++p;
+        }
+        if (field == 2 && states > 2)
+            parsed.states = states < LIFE_MAX_STATES ? states : LIFE_MAX_STATES;
+
+        // skip to the next field, unnamed fields are S, B then C
+        while (*p == ' ')
+            ++p;
+        if (*p == '/')
+        {
+            ++p;
+            field = named ? 2 : field + 1;
+        }
+        else if (*p && *p != ',' && *p != '\n')
+        {
+            ++p; // not part of a rule
+        }
+    }
+    return parsed;
+}
+
+// A pattern decoded from RLE at compile time (see life_compile_rle()). The rows are
+// trimmed to the bounding box of the live cells, bit x of rows[y] is the cell (x, y).
+// Patterns can be wider than a board (for the universe, see life_load_pattern()).
+#define LIFE_PATTERN_WIDTH 64  // widest pattern kept, bigger ones are clipped
+#define LIFE_PATTERN_HEIGHT 32 // tallest pattern kept
 
-        if (in_header)
+typedef struct
+{
+    const char *name;
+    uint8_t width, height; // bounding box
+    uint64_t rows[LIFE_PATTERN_HEIGHT];
+    life_rule_t rule;
+    bool unbounded; // grows forever, run it in the universe
+} life_pattern_t;
+
+// Decode an RLE pattern and the rule in its header (Life if it has none). Only meant to
+// be evaluated by the compiler to fill lifePatterns, use life_load_pattern() to put one
+// on a board.
+constexpr life_pattern_t life_compile_rle(const char *name, const char *rle, bool unbounded = false)
+{
+    life_pattern_t pattern = {};
+    pattern.name = name;
+    pattern.unbounded = unbounded;
+    pattern.rule = LIFE_CONWAY;
+
+    size_t x = 0, y = 0;
+    size_t run = 0;
+    const char *p = rle;
+
+    // the header line, e.g. "x = 3, y = 3, rule = B3/S23"
+    for (; *p && *p != '\n'; ++p)
+    {
+        if (p[0] == 'r' && p[1] == 'u' && p[2] == 'l' && p[3] == 'e')
         {
-            if (c == '\n')
-                in_header = 0;
-            continue; // skip header lines until first newline
+            p += 4;
+            while (*p == ' ' || *p == '=')
+                ++p;
+            pattern.rule = life_parse_rule(p);
+            while (*p && *p != '\n')
+                ++p;
+            break;
         }
+    }
 
-        if (isdigit((unsigned char)c))
+    for (; *p && *p != '!'; ++p)
+    {
+        char c = *p;
+        if (c >= '0' && c <= '9')
         {
             run = run * 10 + (size_t)(c - '0');
             continue;
         }
 
-        if (c == 'b' || c == 'o')
+        size_t count = (run == 0) ? 1 : run;
+        run = 0;
+        if (c == 'o')
         {
-            size_t count = (run == 0) ? 1 : run;
-            bool val = (c == 'o') ? 1 : 0;
-            for (size_t i = 0; i < count; ++i)
+            for (size_t i = 0; i < count; ++i, ++x)
             {
-                if (x < life->width && y < life->height)
-                {
-                    life_set(life, x, y, val);
-                }
-                x++;
+                if (x < LIFE_PATTERN_WIDTH && y < LIFE_PATTERN_HEIGHT)
+                    pattern.rows[y] |= 1ull << x;
             }
-            run = 0;
-        }
-        else if (c == '$')
-        {
-            size_t count = (run == 0) ? 1 : run;
-            run = 0;
-            y += count;
-            x = x0;
         }
-        else if (c == '!')
+        else if (c == 'b')
         {
-            break; // end of pattern
+            x += count;
         }
-        else if (c == '\n' || c == '\r' || c == ' ' || c == '\t')
+        else if (c == '$')
         {
-            // ignore whitespace
+            y += count;
+            x = 0;
         }
         else if (c == '#')
         {
             // comment until newline
-            while (*p && *p != '\n')
+            while (p[1] && p[1] != '\n')
                 ++p;
         }
-        else
+        // anything else (whitespace) is ignored
+    }
+
+    // trim the empty rows and columns around the live cells
+    uint64_t columns = 0;
+    size_t top = LIFE_PATTERN_HEIGHT, bottom = 0;
+    for (size_t row = 0; row < LIFE_PATTERN_HEIGHT; ++row)
+    {
+        if (pattern.rows[row])
         {
-            // Unknown char; ignore to be permissive
+            columns |= pattern.rows[row];
+            if (top == LIFE_PATTERN_HEIGHT)
+                top = row;
+            bottom = row;
         }
     }
-    return 0;
+    if (!columns)
+        return pattern;
+
+    size_t left = 0, right = 0;
+    while (!((columns >> left) & 1))
+        left++;
+    for (size_t column = 0; column < LIFE_PATTERN_WIDTH; ++column)
+    {
+        if ((columns >> column) & 1)
+            right = column;
+    }
+
+    for (size_t row = 0; row < LIFE_PATTERN_HEIGHT; ++row)
+        pattern.rows[row] = row + top <= bottom ? pattern.rows[row + top] >> left : 0;
+    pattern.width = right - left + 1;
+    pattern.height = bottom - top + 1;
+    return pattern;
 }
 
 void life_destroy(life_t *life)
@@ -141,23 +286,40 @@ void life_destroy(life_t *life)
         return;
     free(life->curr);
     free(life->next);
+    free(life->age);
+    free(life->shade);
+    free(life->shown);
+    hashlife_destroy(life->universe);
     free(life);
     return;
 }
 
 life_t *life_create(size_t width, size_t height, bool torus)
 {
+    // a row has to fit in a word
+    if (width < 1 || width > 32)
+        return NULL;
+
     life_t *life = (life_t *)malloc(sizeof(life_t));
     if (!life)
         return NULL;
     life->width = width;
     life->height = height;
     life->torus = torus;
-    life->nbits = width * height;
-    life->nbytes = (life->nbits + 7) / 8;
-    life->curr = (uint8_t *)calloc(life->nbytes, 1);
-    life->next = (uint8_t *)calloc(life->nbytes, 1);
-    if (!life->curr || !life->next)
+    life->nbytes = height * sizeof(uint32_t);
+    life->mask = width == 32 ? UINT32_MAX : (1u << width) - 1;
+    life->rule = LIFE_CONWAY;
+    life->planes = 0;
+    life->universe = NULL;
+    life->unbounded = false;
+    life->stepLog2 = 0;
+    life->curr = (uint32_t *)calloc(height, sizeof(uint32_t));
+    life->next = (uint32_t *)calloc(height, sizeof(uint32_t));
+    life->age = (uint32_t *)calloc(LIFE_AGE_PLANES * height, sizeof(uint32_t));
+    life->shade = (uint32_t *)calloc(LIFE_SHADE_PLANES * height, sizeof(uint32_t));
+    life->shown = (uint32_t *)calloc(LIFE_SHADE_PLANES * height, sizeof(uint32_t));
+    life->repaint = true;
+    if (!life->curr || !life->next || !life->age || !life->shade || !life->shown)
     {
         life_destroy(life);
         return NULL;
@@ -165,46 +327,231 @@ life_t *life_create(size_t width, size_t height, bool torus)
     return life;
 }
 
-void life_step(life_t *life)
+// Switch to a new rule, any dying cells are cleared
+void life_set_rule(life_t *life, const life_rule_t &rule)
 {
-    if (!life)
-        return;
+    life->rule = rule;
+    life->planes = 0;
+    if (rule.states > 2)
+    {
+        // enough planes to count up to rule.states - 1
+        while ((1u << life->planes) < rule.states)
+            life->planes++;
+    }
+    memset(life->age, 0, LIFE_AGE_PLANES * life->nbytes);
+}
 
-    const size_t W = life->width, H = life->height;
-    memset(life->next, 0, life->nbytes);
+// The neighbors to the left and right of every cell in a row (bit x of the result
+// is the cell at x - 1 or x + 1 of the row)
+static inline uint32_t row_left(const life_t *life, uint32_t row)
+{
+    if (life->torus)
+        return ((row << 1) | (row >> (life->width - 1))) & life->mask;
+    return (row << 1) & life->mask;
+}
+
+static inline uint32_t row_right(const life_t *life, uint32_t row)
+{
+    if (life->torus)
+        return ((row >> 1) | (row << (life->width - 1))) & life->mask;
+    return row >> 1;
+}
+
+// The cells of a row whose neighbor count is in counts (bit n for n neighbors), given the
+// count as bit planes. Only the counts the rule uses are tested, not each cell.
+static inline uint32_t row_match(uint16_t counts, uint32_t ones, uint32_t twos, uint32_t fours, uint32_t eights)
+{
+    uint32_t match = 0;
+    for (; counts; counts &= counts - 1)
+    {
+        int n = __builtin_ctz(counts);
+        match |= (n & 1 ? ones : ~ones) & (n & 2 ? twos : ~twos) & (n & 4 ? fours : ~fours) & (n & 8 ? eights : ~eights);
+    }
+    return match;
+}
+
+// Step a whole row at once. The eight neighbor counts of the 32 cells are added up in
+// parallel as bit planes (ones, twos, fours, eights) with full adders, then matched
+// against the birth and survival counts of the rule. Dying cells (Generations rules)
+// aren't neighbors and can't be born.
+static inline uint32_t row_step(const life_t *life, uint32_t above, uint32_t row, uint32_t below, uint32_t dying)
+{
+    uint32_t aL = row_left(life, above), aR = row_right(life, above);
+    uint32_t bL = row_left(life, row), bR = row_right(life, row);
+    uint32_t cL = row_left(life, below), cR = row_right(life, below);
+
+    // count each row: above and below have 3 neighbors (0..3 as two bits), the row itself 2
+    uint32_t aOnes = aL ^ above ^ aR;
+    uint32_t aTwos = (aL & above) | (aR & (aL ^ above));
+    uint32_t cOnes = cL ^ below ^ cR;
+    uint32_t cTwos = (cL & below) | (cR & (cL ^ below));
+    uint32_t bOnes = bL ^ bR;
+    uint32_t bTwos = bL & bR;
+
+    // add the ones, then the twos including the carry from the ones
+    uint32_t ones = aOnes ^ bOnes ^ cOnes;
+    uint32_t onesCarry = (aOnes & bOnes) | (cOnes & (aOnes ^ bOnes));
+    uint32_t twosSum = aTwos ^ bTwos ^ cTwos;
+    uint32_t twosCarry = (aTwos & bTwos) | (cTwos & (aTwos ^ bTwos));
+    uint32_t twos = twosSum ^ onesCarry;
+    uint32_t fours = twosCarry ^ (twosSum & onesCarry);
+    uint32_t eights = twosCarry & twosSum & onesCarry;
+
+    uint32_t born = row_match(life->rule.birth, ones, twos, fours, eights) & ~row & ~dying;
+    uint32_t survive = row_match(life->rule.survival, ones, twos, fours, eights) & row;
+    return (born | survive) & life->mask;
+}
+
+// Age the dying cells of row y by one state and start the cells that just died at the
+// first dying state. Cells that run out of states are dead.
+static inline void row_age(life_t *life, size_t y, uint32_t dying, uint32_t died)
+{
+    uint32_t *age = life->age + y;
+    const size_t H = life->height;
+
+    // add one to the dying cells
+    uint32_t carry = dying;
+    for (size_t plane = 0; plane < life->planes; ++plane)
+    {
+        uint32_t bits = age[plane * H];
+        age[plane * H] = bits ^ carry;
+        carry &= bits;
+    }
+
+    // clear the cells that reached the last state + 1 (counted as states - 1)
+    uint32_t expired = dying;
+    for (size_t plane = 0; plane < life->planes; ++plane)
+        expired &= (((life->rule.states - 1) >> plane) & 1) ? age[plane * H] : ~age[plane * H];
+    for (size_t plane = 0; plane < life->planes; ++plane)
+        age[plane * H] &= ~expired;
+
+    age[0] |= died;
+}
+
+// Update the display code of row y after a step from the live cells before and after it:
+//   0       empty
+//   1..7    a live cell, its age in generations (1 is newborn, saturates at 7)
+//   15..8   a ghost fading out after the cell died, one step per generation (held at 8
+//           while the cell of a Generations rule is still dying)
+// The planes are bits 0..3 of the code and are updated with the same kind of whole row
+// logic as the step.
+static inline void row_shade(life_t *life, size_t y, uint32_t before, uint32_t after, uint32_t dying)
+{
+    const size_t H = life->height;
+    uint32_t *shade = life->shade + y;
+    uint32_t b0 = shade[0], b1 = shade[H], b2 = shade[2 * H], b3 = shade[3 * H];
+
+    uint32_t born = after & ~before;
+    uint32_t survived = after & before;
+    uint32_t died = before & ~after;
+    uint32_t ghost = b3 & ~after;
+
+    // survivors count up to 7
+    uint32_t up = ~(b0 & b1 & b2);
+    uint32_t i0 = b0 ^ up, c1 = b0 & up;
+    uint32_t i1 = b1 ^ c1, c2 = b1 & c1;
+    uint32_t i2 = b2 ^ c2;
+
+    // ghosts count down to 8, then vanish (or stay while still dying)
+    uint32_t low = b0 | b1 | b2;
+    uint32_t d0 = b0 ^ low, borrow1 = ~b0 & low;
+    uint32_t d1 = b1 ^ borrow1, borrow2 = ~b1 & borrow1;
+    uint32_t d2 = b2 ^ borrow2;
+    uint32_t keep = ghost & (life->planes ? dying : low);
+
+    shade[0] = born | (survived & i0) | died | (keep & d0);
+    shade[H] = (survived & i1) | died | (keep & d1);
+    shade[2 * H] = (survived & i2) | died | (keep & d2);
+    shade[3 * H] = died | keep;
+}
+
+// Start the display codes over with every live cell newborn
+static void life_reset_shade(life_t *life)
+{
+    memset(life->shade, 0, LIFE_SHADE_PLANES * life->nbytes);
+    memcpy(life->shade, life->curr, life->nbytes);
+}
+
+// Move the board toward the busiest part of the universe and copy the cells under it
+// into the next generation
+static void life_universe_view(life_t *life)
+{
+    int64_t x, y;
+    if (hashlife_focus(life->universe, x, y))
+    {
+        // ease a quarter of the way there each generation
+        int64_t dx = x - (int64_t)life->width / 2 - life->viewX;
+        int64_t dy = y - (int64_t)life->height / 2 - life->viewY;
+        life->viewX += dx / 4 ? dx / 4 : (dx > 0) - (dx < 0);
+        life->viewY += dy / 4 ? dy / 4 : (dy > 0) - (dy < 0);
+    }
+    hashlife_read(life->universe, life->viewX, life->viewY, life->width, life->height, life->next);
+}
 
+// step the board into the next generation
+static void life_step_board(life_t *life)
+{
+    const size_t H = life->height;
     for (size_t y = 0; y < H; ++y)
     {
-        for (size_t x = 0; x < W; ++x)
+        uint32_t above, below;
+        if (life->torus)
+        {
+            above = life->curr[y == 0 ? H - 1 : y - 1];
+            below = life->curr[y == H - 1 ? 0 : y + 1];
+        }
+        else
         {
-            uint8_t neighbors =
-                life_get(life, (long)x - 1, (long)y - 1) +
-                life_get(life, (long)x, (long)y - 1) +
-                life_get(life, (long)x + 1, (long)y - 1) +
-                life_get(life, (long)x - 1, (long)y) +
-                life_get(life, (long)x + 1, (long)y) +
-                life_get(life, (long)x - 1, (long)y + 1) +
-                life_get(life, (long)x, (long)y + 1) +
-                life_get(life, (long)x + 1, (long)y + 1);
-
-            uint8_t alive = life_get(life, x, y);
-            uint8_t next_state = (alive ? (neighbors == 2 || neighbors == 3) : (neighbors == 3));
-
-            size_t idx = y * W + x;
-            size_t byte = idx >> 3;
-            size_t bit = idx & 7;
-            if (next_state)
-                life->next[byte] |= (1 << bit);
+            above = y == 0 ? 0 : life->curr[y - 1];
+            below = y == H - 1 ? 0 : life->curr[y + 1];
+        }
+        if (life->planes)
+        {
+            uint32_t dying = life_dying(life, y);
+            life->next[y] = row_step(life, above, life->curr[y], below, dying);
+            row_age(life, y, dying, life->curr[y] & ~life->next[y]);
+            row_shade(life, y, life->curr[y], life->next[y], life_dying(life, y));
+        }
+        else
+        {
+            life->next[y] = row_step(life, above, life->curr[y], below, 0);
+            row_shade(life, y, life->curr[y], life->next[y], 0);
         }
     }
+}
+
+uint32_t *life_rows(life_t *life)
+{
+    return life->curr;
+}
+
+void life_step(life_t *life)
+{
+    if (!life)
+        return;
+
+    if (life->unbounded)
+    {
+        // a universe that has grown too big is emptied, which ends the pattern
+        if (!hashlife_step(life->universe, life->stepLog2))
+            hashlife_clear(life->universe, life->rule.birth, life->rule.survival);
+        life_universe_view(life);
+        for (size_t y = 0; y < life->height; ++y)
+            row_shade(life, y, life->curr[y], life->next[y], 0);
+    }
+    else
+    {
+        life_step_board(life);
+    }
+
     // swap buffers
-    uint8_t *tmp = life->curr;
+    uint32_t *tmp = life->curr;
     life->curr = life->next;
     life->next = tmp;
 }
 
 //
-// integrate the Conway's Game of Life mode into Marble Madness
+// integrate the Game of Life mode into Marble Madness
 //
 
 //
@@ -227,7 +574,7 @@ void life_step(life_t *life)
 // Starts as a line of 3 cells. Period = 2.
 // Alternates between vertical and horizontal line every generation.
 // Fits in a 3x3 box, never grows.
-const char *blinker =
+constexpr const char *blinker =
     "x = 3, y = 1, rule = B3/S23\n"
     "3o!\n";
 
@@ -236,7 +583,7 @@ const char *blinker =
 // Looks like two rows offset by one cell.
 // Flips between two phases where the cells shift positions slightly.
 // Fits in 4x4, stable and bounded.
-const char *toad =
+constexpr const char *toad =
     "x = 4, y = 2, rule = B3/S23\n"
     "b3o$\n"
     "3ob!\n";
@@ -245,7 +592,7 @@ const char *toad =
 // Place at (10,10). Safe margin: 9 cells around.
 // The inner corners toggle on and off, creating a flashing effect.
 // Fits in 4x4, stable and bounded.
-const char *beacon =
+constexpr const char *beacon =
     "x = 4, y = 4, rule = B3/S23\n"
     "2o2b$\n"
     "2o2b$\n"
@@ -257,7 +604,7 @@ const char *beacon =
 // Its arms expand and contract in a repeating cycle.
 // Fits in 13x13, well within a 19x19 board.
 // Famous as one of the most iconic oscillators in Life.
-const char *pulsar =
+constexpr const char *pulsar =
     "x = 13, y = 13, rule = B3/S23\n"
     "2b3o3b3o2b$\n"
     "bobo3bobo3b$\n"
@@ -279,7 +626,7 @@ const char *pulsar =
 // Starts with 5 cells. Period = 4.
 // Moves diagonally across the board forever.
 // Fits in 3x3, but travels — give it margin inside 19x19.
-const char *glider =
+constexpr const char *glider =
     "x = 3, y = 3, rule = B3/S23\n"
     "bo2b$\n"
     "2bo$\n"
@@ -291,7 +638,7 @@ const char *glider =
 // Starts with 9 cells. Period = 4.
 // Moves horizontally across the board forever.
 // Fits in 5x4, safe inside 19x19 if placed with margin.
-const char *lwss =
+constexpr const char *lwss =
     "x = 5, y = 4, rule = B3/S23\n"
     "bo2bo$\n"
     "o4b$\n"
@@ -307,7 +654,7 @@ const char *lwss =
 // Evolves for 5206 generations before vanishing.
 // Produces hundreds of transient cells along the way.
 // Fits in 7x3, safe for 19x19. Long-lived extinction case.
-const char *acorn =
+constexpr const char *acorn =
     "x = 7, y = 3, rule = B3/S23\n"
     "bo6b$\n"
     "3bo4b$\n"
@@ -318,7 +665,7 @@ const char *acorn =
 // Evolves chaotically for 1103 generations before stabilizing.
 // Produces a zoo of oscillators and still lifes.
 // Fits in 3x3, safe for 19x19. Classic stress test.
-const char *r_pentomino =
+constexpr const char *r_pentomino =
     "x = 3, y = 3, rule = B3/S23\n"
     "bo2b$\n"
     "2oo$\n"
@@ -332,7 +679,7 @@ const char *r_pentomino =
 // Place at (6,8). Safe margin: 6 cells around.
 // Lives for exactly 130 generations before vanishing completely.
 // Fits in 7x3, safe for 19x19. Great extinction test case.
-const char *diehard =
+constexpr const char *diehard =
     "x = 7, y = 3, rule = B3/S23\n"
     "6bo$\n"
     "2o5b$\n"
@@ -343,38 +690,39 @@ const char *diehard =
 // This is a compact, canonical, infinite‑growth seed. Place it near the upper left on a sufficiently large board.
 //
 
-const char *gosper =
+constexpr const char *gosper =
     "x = 36, y = 9, rule = B3/S23\n"
-    "24bo11b$\n"
-    "22bobo11b$\n"
-    "12bo8b2o3bobo11b$\n"
-    "11bobo6bo2bo3bo2bo10b$\n"
-    "2bo8b2o6bo2bo3bo2bo10b$\n"
-    "bobo6bo2bo6bo2bo3b2o3bo6b$\n"
-    "bobo6bo2bo6bo2bo8bobo5b$\n"
-    "2bo8b2o8b2o9bo6b$\n"
-    "12bo23b!\n";
+    "24bo$\n"
+    "22bobo$\n"
+    "12b2o6b2o12b2o$\n"
+    "11bo3bo4b2o12b2o$\n"
+    "2o8bo5bo3b2o$\n"
+    "2o8bo3bob2o4bobo$\n"
+    "10bo5bo7bo$\n"
+    "11bo3bo$\n"
+    "12b2o!\n";
 
 //
 // 10‑cell infinite growth (block‑laying switch engine)
 // A minimal seed discovered by Paul Callahan; also yields unbounded growth:
 // small blocks are laid down as the pattern expands.
 //
-const char *blocklaying =
-    "x = 10, y = 5, rule = B3/S23\n"
-    "bo3bo2b$\n"
-    "b2obo2b$\n"
-    "2o2b2o2b$\n"
-    "3bo3b$\n"
-    "2b2o2b!\n";
+constexpr const char *blocklaying =
+    "x = 8, y = 6, rule = B3/S23\n"
+    "6bo$\n"
+    "4bob2o$\n"
+    "4bobo$\n"
+    "4bo$\n"
+    "2bo$\n"
+    "obo!\n";
 
-const char *block =
+constexpr const char *block =
     "x = 2, y = 2, rule = B3/S23\n"
     "2o$\n"
     "2o!\n";
 
 // Beehive (6x5 bbox but 6x4 active)
-const char *beehive =
+constexpr const char *beehive =
     "x = 6, y = 5, rule = B3/S23\n"
     "2b2o2b$\n"
     "bo4b$\n"
@@ -383,7 +731,7 @@ const char *beehive =
     "6b!\n";
 
 // Loaf (canonical compact loaf, 4x4 bbox)
-const char *loaf =
+constexpr const char *loaf =
     "x = 4, y = 4, rule = B3/S23\n"
     "b2ob$\n"
     "o2bo$\n"
@@ -391,14 +739,14 @@ const char *loaf =
     "2b2o!\n";
 
 // Boat (5x4 bbox)
-const char *boat =
+constexpr const char *boat =
     "x = 5, y = 4, rule = B3/S23\n"
     "bo2b2$\n"
     "bobo2$\n"
     "2bo2b$\n"
     "2b2o!\n";
 
-const char *clock_pattern =
+constexpr const char *clock_pattern =
     "x = 6, y = 6, rule = B3/S23\n"
     "2bo2b2$\n"
     "b3o2b$\n"
@@ -407,7 +755,7 @@ const char *clock_pattern =
     "2b2ob2$\n"
     "2b2o2b!\n";
 
-const char *pentadecathlon =
+constexpr const char *pentadecathlon =
     "x = 18, y = 11, rule = B3/S23\n"
     "6b2o2b2o6b$\n"
     "6b2o2b2o6b$\n"
@@ -421,20 +769,20 @@ const char *pentadecathlon =
     "6b2o2b2o6b$\n"
     "6b2o2b2o6b!\n";
 
-const char *blinker_vertical =
+constexpr const char *blinker_vertical =
     "x = 1, y = 3, rule = B3/S23\n"
     "o$\n"
     "o$\n"
     "o!\n";
 
 // Toad (canonical 4x2)
-const char *toad_compact =
+constexpr const char *toad_compact =
     "x = 4, y = 2, rule = B3/S23\n"
     "b3o$\n"
     "o3b!\n";
 
 // Beacon (canonical 6x6)
-const char *beacon_6x6 =
+constexpr const char *beacon_6x6 =
     "x = 6, y = 6, rule = B3/S23\n"
     "2o2b2o$\n"
     "2o2b2o$\n"
@@ -442,73 +790,315 @@ const char *beacon_6x6 =
     "2o2b2o$\n"
     "2o2b2o!\n";
 
+//
+//  🧪 Other rules (the rule in the header is the one the pattern runs under)
+//
+
+// Replicator: HighLife (B36/S23) is Life plus birth on 6 neighbors.
+// Makes copies of itself along the diagonal every 12 generations.
+constexpr const char *replicator =
+    "x = 5, y = 5, rule = B36/S23\n"
+    "2b3o$\n"
+    "bo2bo$\n"
+    "o3bo$\n"
+    "o2bo$\n"
+    "3o!\n";
+
+// Day & Night (B3678/S34678): live and dead cells behave the same way.
+// A small blob that settles into a period 4 oscillator.
+constexpr const char *day_and_night =
+    "x = 4, y = 4, rule = B3678/S34678\n"
+    "b2o$\n"
+    "4o$\n"
+    "4o$\n"
+    "b2o!\n";
+
+// Seeds (B2/S): every live cell dies each generation.
+// Two cells that burst outward until they run into the edges and burn out.
+constexpr const char *seeds =
+    "x = 2, y = 1, rule = B2/S\n"
+    "2o!\n";
+
+// Brian's Brain (B2/S/C3): a Generations rule, cells die through one dying state.
+// A block that sends out waves of sparks.
+constexpr const char *brians_brain =
+    "x = 2, y = 2, rule = B2/S/C3\n"
+    "2o$\n"
+    "2o!\n";
+
+// Star Wars (345/2/4 in S/B/C order): Generations with two dying states.
+constexpr const char *star_wars =
+    "x = 3, y = 3, rule = 345/2/4\n"
+    "3o$\n"
+    "obo$\n"
+    "3o!\n";
+
+// The patterns LoadRandomPattern() picks from, decoded when the firmware is compiled
+#define LIFE_PATTERN(rle) life_compile_rle(#rle, rle)
+#define LIFE_PATTERN_UNBOUNDED(rle) life_compile_rle(#rle, rle, true)
+
+inline constexpr life_pattern_t lifePatterns[] = {
+    // LIFE_PATTERN(blinker),
+    LIFE_PATTERN(toad),
+    LIFE_PATTERN(beacon),
+    LIFE_PATTERN(pulsar),
+    LIFE_PATTERN(glider),
+    LIFE_PATTERN(lwss),
+    LIFE_PATTERN(acorn),
+    LIFE_PATTERN(r_pentomino),
+    LIFE_PATTERN(diehard),
+    LIFE_PATTERN_UNBOUNDED(gosper),
+    LIFE_PATTERN_UNBOUNDED(blocklaying),
+    LIFE_PATTERN(block),
+    LIFE_PATTERN(beehive),
+    LIFE_PATTERN(loaf),
+    LIFE_PATTERN(boat),
+    LIFE_PATTERN(clock_pattern),
+    LIFE_PATTERN(pentadecathlon),
+    // LIFE_PATTERN(blinker_vertical),
+    LIFE_PATTERN(toad_compact),
+    LIFE_PATTERN(beacon_6x6),
+    LIFE_PATTERN(replicator),
+    LIFE_PATTERN(day_and_night),
+    LIFE_PATTERN(seeds),
+    LIFE_PATTERN(brians_brain),
+    LIFE_PATTERN(star_wars)};
+
+// The color of each display code (see row_shade())
+static CRGB lifePalette[1 << LIFE_SHADE_PLANES];
+
+static void life_set_palette()
+{
+    lifePalette[0] = CRGB::Black;
+
+    // live cells are born green and turn white as they mature
+    for (int age = 1; age <= 7; ++age)
+        lifePalette[age] = blend(CRGB(64, 255, 64), CRGB::White, (age - 1) * 255 / 6);
+
+    // ghosts fade out through the dark end of the heat colors
+    for (int code = 8; code <= 15; ++code)
+        lifePalette[code] = ColorFromPalette(HeatColors_p, (code - 7) * 10);
+}
+
+// Draw the cells whose display code changed since they were last drawn
+static void life_draw(life_t *life)
+{
+    const size_t H = life->height;
+    for (size_t y = 0; y < H; ++y)
+    {
+        const uint32_t *shade = life->shade + y;
+        uint32_t *shown = life->shown + y;
+        uint32_t changed = life->repaint ? life->mask : 0;
+        for (size_t plane = 0; plane < LIFE_SHADE_PLANES; ++plane)
+        {
+            changed |= shade[plane * H] ^ shown[plane * H];
+            shown[plane * H] = shade[plane * H];
+        }
+
+        CRGB *row = frame_row(y);
+        for (; changed; changed &= changed - 1)
+        {
+            int x = __builtin_ctz(changed);
+            uint8_t code = ((shade[0] >> x) & 1) | ((shade[H] >> x) & 1) << 1 | ((shade[2 * H] >> x) & 1) << 2 | ((shade[3 * H] >> x) & 1) << 3;
+            row[x] = lifePalette[code];
+        }
+    }
+    life->repaint = false;
+}
+
+// ----- universe -----
+// Patterns that grow forever (guns, switch engines) would run into the edge of the
+// board, so they run in a HashLife universe instead and the board shows a window onto
+// it. The number of generations per frame doubles every LIFE_WARP_FRAMES frames up to
+// 2^LIFE_MAX_STEP_LOG2 so the pattern can be seen growing for tens of thousands of
+// generations.
+#define LIFE_UNIVERSE_NODES (1 << 16)       // quadtree nodes (32 bytes each, in PSRAM)
+#define LIFE_UNIVERSE_GENERATIONS (1 << 16) // how long an unbounded pattern runs
+#define LIFE_WARP_FRAMES 32
+#define LIFE_MAX_STEP_LOG2 8
+
+static int life_frames; // frames the current pattern has been shown
+
+// Put a pattern in the universe centered under the board, false if it can't run there
+// (Generations and B0 rules or no memory for the universe)
+static bool life_load_universe(life_t *life, const life_pattern_t &pattern)
+{
+    if (pattern.rule.states > 2 || (pattern.rule.birth & 1))
+        return false;
+    if (!life->universe)
+        life->universe = hashlife_create(LIFE_UNIVERSE_NODES);
+    if (!life->universe)
+        return false;
+
+    hashlife_clear(life->universe, pattern.rule.birth, pattern.rule.survival);
+    for (size_t y = 0; y < pattern.height; ++y)
+    {
+        for (size_t x = 0; x < pattern.width; ++x)
+        {
+            if ((pattern.rows[y] >> x) & 1)
+                hashlife_set(life->universe, x, y);
+        }
+    }
+    life->unbounded = true;
+    life->stepLog2 = 0;
+    life->viewX = ((int64_t)pattern.width - (int64_t)life->width) / 2;
+    life->viewY = ((int64_t)pattern.height - (int64_t)life->height) / 2;
+    hashlife_read(life->universe, life->viewX, life->viewY, life->width, life->height, life->curr);
+    return true;
+}
+
+// OR a pattern into the board centered (patterns bigger than the board are placed at
+// the top left and clipped) or into the universe if it is unbounded
+static void life_load_pattern(life_t *life, const life_pattern_t &pattern)
+{
+    life->unbounded = false;
+    if (pattern.unbounded && life_load_universe(life, pattern))
+        return;
+
+    size_t x0 = pattern.width < life->width ? (life->width - pattern.width) / 2 : 0;
+    size_t y0 = pattern.height < life->height ? (life->height - pattern.height) / 2 : 0;
+    for (size_t y = 0; y < pattern.height && y0 + y < life->height; ++y)
+        life->curr[y0 + y] |= (uint32_t)(pattern.rows[y] << x0) & life->mask;
+}
+
 life_t *life;
 int generation_max, generation;
 
-void LoadRandomPattern(life_t *life)
+// ----- settling -----
+// Rather than running every pattern for a fixed number of generations, a hash of each
+// generation is kept for the last LIFE_HISTORY generations. A board that matches one
+// from p generations ago is cycling with period p (1 is a still life), and one whose
+// live cells match the shape of an earlier board but somewhere else is a spaceship
+// moving with period p. Once a pattern has settled it is shown for a few more cycles
+// and then replaced, patterns that are still evolving get up to LIFE_MAX_GENERATIONS.
+#define LIFE_HISTORY 64           // generations of hashes kept (the longest period found is one less)
+#define LIFE_MAX_GENERATIONS 1000 // give up on a pattern that hasn't settled by then
+#define LIFE_LINGER 16            // fewest generations a settled pattern stays
+
+typedef enum
 {
-// select a random pattern to load
+    LIFE_EVOLVING,
+    LIFE_EXTINCT,
+    LIFE_STILL,
+    LIFE_OSCILLATING,
+    LIFE_TRANSLATING,
+} LIFE_STATE;
+
 #ifdef DEBUG
-    const char *pattern_names[] = {
-        //        "blinker",
-        "toad",
-        "beacon",
-        "pulsar",
-        "glider",
-        "lwss",
-        "acorn",
-        "r_pentomino",
-        "diehard",
-        "gosper",
-        "blocklaying",
-        "block",
-        "beehive",
-        "loaf",
-        "boat",
-        "clock_pattern",
-        "pentadecathlon",
-        //        "blinker_vertical",
-        "toad_compact",
-        "beacon_6x6"};
+static const char *life_state_names[] = {"reached the generation limit", "died out", "became a still life", "oscillated", "translated"};
 #endif // DEBUG
-    const char *patterns[] = {
-        //        blinker,
-        toad,
-        beacon,
-        pulsar,
-        glider,
-        lwss,
-        acorn,
-        r_pentomino,
-        diehard,
-        gosper,
-        blocklaying,
-        block,
-        beehive,
-        loaf,
-        boat,
-        clock_pattern,
-        pentadecathlon,
-        //        blinker_vertical,
-        toad_compact,
-        beacon_6x6};
-    int index = random16(sizeof(patterns) / sizeof(patterns[0]));
-    const char *pattern = patterns[index];
 
+static uint64_t boardHashes[LIFE_HISTORY]; // the whole board
+static uint64_t shapeHashes[LIFE_HISTORY]; // the live cells relative to their bounding box
+static LIFE_STATE life_state;
+static int life_period;
+
+#define FNV64_OFFSET 14695981039346656037ull
+#define FNV64_PRIME 1099511628211ull
+
+// Hash the current generation and compare it with the ones before, call once per
+// generation (including generation 0)
+static void life_classify(const life_t *life)
+{
+    uint64_t board = FNV64_OFFSET;
+    uint32_t columns = 0;
+    int top = -1, bottom = -1;
+    for (size_t y = 0; y < life->height; ++y)
+    {
+        uint32_t cells = life->curr[y] | life_dying(life, y);
+        board = (board ^ life->curr[y]) * FNV64_PRIME;
+        for (size_t plane = 0; plane < life->planes; ++plane)
+            board = (board ^ life->age[plane * life->height + y]) * FNV64_PRIME;
+        if (cells)
+        {
+            columns |= cells;
+            if (top < 0)
+                top = y;
+            bottom = y;
+        }
+    }
+
+    LIFE_STATE state = LIFE_EVOLVING;
+    int period = 0;
+    uint64_t shape = FNV64_OFFSET;
+    if (!columns)
+    {
+        state = LIFE_EXTINCT;
+    }
+    else
+    {
+        // move the live cells to the top left corner (bounding box)
+        int left = __builtin_ctz(columns);
+        for (int y = top; y <= bottom; ++y)
+        {
+            shape = (shape ^ (life->curr[y] >> left)) * FNV64_PRIME;
+            for (size_t plane = 0; plane < life->planes; ++plane)
+                shape = (shape ^ (life->age[plane * life->height + y] >> left)) * FNV64_PRIME;
+        }
+
+        // look for the most recent generation with the same shape
+        for (int p = 1; p <= generation && p < LIFE_HISTORY; p++)
+        {
+            int i = (generation - p) % LIFE_HISTORY;
+            if (shapeHashes[i] == shape)
+            {
+                state = boardHashes[i] == board ? (p == 1 ? LIFE_STILL : LIFE_OSCILLATING) : LIFE_TRANSLATING;
+                period = p;
+                break;
+            }
+        }
+    }
+
+    boardHashes[generation % LIFE_HISTORY] = board;
+    shapeHashes[generation % LIFE_HISTORY] = shape;
+
+    // the first time the pattern settles, cut its run short (spaceships get long enough
+    // to cross the board, they move at most one cell per period)
+    if (state != LIFE_EVOLVING && life_state == LIFE_EVOLVING)
+    {
+        size_t size = life->width > life->height ? life->width : life->height;
+        int linger = state == LIFE_TRANSLATING ? size * period : 3 * period;
+        if (linger < LIFE_LINGER)
+            linger = LIFE_LINGER;
+        if (generation + linger < generation_max)
+            generation_max = generation + linger;
+        life_state = state;
+        life_period = period;
+    }
+}
+
+void LoadRandomPattern(life_t *life)
+{
     // reset the board
     memset(life->curr, 0, life->nbytes);
     memset(life->next, 0, life->nbytes);
 
-    // load the pattern at the center of the board
-    size_t x0 = life->width / 2;
-    size_t y0 = life->height / 2;
-    life_load_rle(life, pattern, 3, 3);
-#ifdef DEBUG
-    DB_PRINTF("Loaded pattern: %s\n", pattern_names[index]);
-#endif // DEBUG
+    // half the time run one of the soups the search has found (see lifesearch.h)
+    life_seed_t seed;
+    if (random8(2) && life_search_pick(seed))
+    {
+        life_set_rule(life, LIFE_CONWAY);
+        life->unbounded = false;
+        life_search_soup(seed.seed, life->curr, life->width, life->height);
+        DB_PRINTF("Loaded soup: %08x (lifetime %u)\n", (unsigned)seed.seed, seed.lifetime);
+    }
+    else
+    {
+        // select a random pattern and load it at the center of the board
+        int index = random16(sizeof(lifePatterns) / sizeof(lifePatterns[0]));
+        const life_pattern_t &pattern = lifePatterns[index];
+        life_set_rule(life, pattern.rule);
+        life_load_pattern(life, pattern);
+        DB_PRINTF("Loaded pattern: %s\n", pattern.name);
+    }
+    life_reset_shade(life);
 
-    generation_max = 100;
+    generation_max = life->unbounded ? LIFE_UNIVERSE_GENERATIONS : LIFE_MAX_GENERATIONS;
     generation = 0;
+    life_frames = 0;
+    life_state = LIFE_EVOLVING;
+    life_period = 0;
+    life_classify(life);
 }
 
 void draw_counter(int count)
@@ -521,10 +1111,12 @@ void draw_counter(int count)
     const int startY = (NUM_ROWS - 5);
     int x = NUM_COLS - 15 + 8;
 
-    //    drawDigit3x5(n1, x, startY, setLEDBlendClockColor); x += 3; x += 1;
-    //    drawDigit3x5(n2, x, startY, setLEDBlendClockColor); x += 3; x += 1;
-    drawDigit3x5(n3, x, startY, setLEDBlendClockColor); x += 3; x += 1;
-    drawDigit3x5(n4, x, startY, setLEDBlendClockColor);
+    // composited over the cells as they are shown rather than drawn into them
+    dl_clear(LAYER_TEXT);
+    //    drawDigit3x5(n1, x, startY, LAYER_TEXT, settings.clockColor); x += 3; x += 1;
+    //    drawDigit3x5(n2, x, startY, LAYER_TEXT, settings.clockColor); x += 3; x += 1;
+    drawDigit3x5(n3, x, startY, LAYER_TEXT, settings.clockColor); x += 3; x += 1;
+    drawDigit3x5(n4, x, startY, LAYER_TEXT, settings.clockColor);
 }
 
 void life_enter()
@@ -534,6 +1126,7 @@ void life_enter()
     if (!life)
         return;
 
+    life_set_palette();
     LoadRandomPattern(life);
 }
 
@@ -544,27 +1137,39 @@ void life_loop()
         timer.setPeriod(MAX_MILLIS - map(settings.speed, MIN_SPEED, MAX_SPEED, MIN_MILLIS, MAX_MILLIS));
 
         // update LED matrix from life state
-        for (size_t y = 0; y < life->height; ++y)
+        life_draw(life);
+
+        life_step(life);
+        if (life->unbounded)
         {
-            for (size_t x = 0; x < life->width; ++x)
+            // the universe never settles, warp ahead until it has run long enough (or died out)
+            generation += 1 << life->stepLog2;
+            if (++life_frames % LIFE_WARP_FRAMES == 0 && life->stepLog2 < LIFE_MAX_STEP_LOG2)
+                life->stepLog2++;
+            if (!hashlife_population(life->universe))
             {
-                leds[XY(x, y)] = life_get(life, x, y) ? CRGB::White : CRGB::Black;
+                life_state = LIFE_EXTINCT;
+                generation_max = generation;
             }
         }
-
-        life_step(life);
-        generation++;
+        else
+        {
+            generation++;
+            life_classify(life);
+        }
         draw_counter(generation);
 
-        // detect when we should reset the patterns
-        if ((generation >= generation_max) || !memcmp(life->curr, life->next, life->nbytes))
+        // start a new pattern once this one has settled down (or run too long)
+        if (generation >= generation_max)
         {
+#ifdef DEBUG
+            DB_PRINTF("Life pattern %s (period %d) after %d generations\r\n", life_state_names[life_state], life_period, generation);
+#endif // DEBUG
             LoadRandomPattern(life);
         }
-        static uint8_t prev_checksum = 0;
-    }
 
-    leds_dirty = true;
+        leds_dirty = true;
+    }
 }
 
 void life_leave()
@@ -1,8 +1,22 @@
 #ifndef LIFE_H
 #define LIFE_H
 
+#include <stdint.h>
+#include <stddef.h>
+
 void life_enter();
 void life_loop();
 void life_leave();
 
+// The bit parallel Life board the mode runs on (B3/S23 until a pattern with another
+// rule is loaded), the soup search steps its own boards with it
+typedef struct life_t life_t;
+
+life_t *life_create(size_t width, size_t height, bool torus);
+void life_destroy(life_t *life);
+void life_step(life_t *life);
+
+// the current generation, one word per row with bit x set if cell x is alive
+uint32_t *life_rows(life_t *life);
+
 #endif // LIFE_H
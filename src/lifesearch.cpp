@@ -0,0 +1,206 @@
+#include "main.h"
+#include "debug.h"
+#include "render.h"
+#include "life.h"
+#include "lifesearch.h"
+#include <LittleFS.h>
+
+#define LIFE_SEARCH_BANK 16              // seeds kept
+#define LIFE_SEARCH_SOUP 10              // soups are 10x10 cells at 50% density
+#define LIFE_SEARCH_GENERATIONS 1000     // the longest the Life mode runs a pattern
+#define LIFE_SEARCH_MIN_LIFETIME 200     // soups that settle sooner aren't kept
+#define LIFE_SEARCH_HISTORY 64           // generations of hashes kept to spot a settled soup
+#define LIFE_SEARCH_SHARE 25             // percent of core 0 the search may use
+#define LIFE_SEARCH_MIN_DELAY 50         // ms to sleep between soups at least
+#define LIFE_SEARCH_PERSIST_MILLIS 60000 // write the bank out at most this often
+#define LIFE_SEARCH_FILE "/lifeseeds.bin"
+#define LIFE_SEARCH_VERSION 1 // if life_seed_t or the soups change, increment this to drop the bank
+
+static life_seed_t bank[LIFE_SEARCH_BANK];
+static uint8_t bankCount = 0;
+static SemaphoreHandle_t bankMutex = NULL;
+static TaskHandle_t searchTaskHandle = NULL;
+
+#define FNV64_OFFSET 14695981039346656037ull
+#define FNV64_PRIME 1099511628211ull
+
+// xorshift32 so a seed makes the same soup on every build
+static uint32_t xorshift32(uint32_t &state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+void life_search_soup(uint32_t seed, uint32_t *rows, size_t width, size_t height)
+{
+    uint32_t state = seed ? seed : 1;
+    size_t x0 = width > LIFE_SEARCH_SOUP ? (width - LIFE_SEARCH_SOUP) / 2 : 0;
+    size_t y0 = height > LIFE_SEARCH_SOUP ? (height - LIFE_SEARCH_SOUP) / 2 : 0;
+    uint32_t mask = width >= 32 ? UINT32_MAX : (1u << width) - 1;
+
+    memset(rows, 0, height * sizeof(uint32_t));
+    for (size_t y = 0; y < LIFE_SEARCH_SOUP && y0 + y < height; ++y)
+        rows[y0 + y] = ((xorshift32(state) & ((1u << LIFE_SEARCH_SOUP) - 1)) << x0) & mask;
+}
+
+// Run a soup until its board repeats within LIFE_SEARCH_HISTORY generations (or it runs
+// out of time), returns the generation it settled at and counts the cells that changed
+static uint16_t life_search_run(life_t *board, uint32_t seed, uint32_t &score)
+{
+    static uint64_t hashes[LIFE_SEARCH_HISTORY];
+
+    life_search_soup(seed, life_rows(board), NUM_COLS, NUM_ROWS);
+    score = 0;
+    for (int generation = 0; generation < LIFE_SEARCH_GENERATIONS; ++generation)
+    {
+        const uint32_t *rows = life_rows(board);
+        uint64_t hash = FNV64_OFFSET;
+        for (size_t y = 0; y < NUM_ROWS; ++y)
+            hash = (hash ^ rows[y]) * FNV64_PRIME;
+        for (int p = 1; p <= generation && p < LIFE_SEARCH_HISTORY; ++p)
+        {
+            if (hashes[(generation - p) % LIFE_SEARCH_HISTORY] == hash)
+                return generation;
+        }
+        hashes[generation % LIFE_SEARCH_HISTORY] = hash;
+
+        // the board swaps buffers so rows still holds this generation after the step
+        life_step(board);
+        const uint32_t *next = life_rows(board);
+        for (size_t y = 0; y < NUM_ROWS; ++y)
+            score += __builtin_popcount(rows[y] ^ next[y]);
+    }
+    return LIFE_SEARCH_GENERATIONS;
+}
+
+// add a seed to the bank if it has room or the seed beats the worst one, true if it did
+static bool life_search_keep(const life_seed_t &found)
+{
+    bool kept = false;
+    if (xSemaphoreTake(bankMutex, portMAX_DELAY))
+    {
+        if (bankCount < LIFE_SEARCH_BANK)
+        {
+            bank[bankCount++] = found;
+            kept = true;
+        }
+        else
+        {
+            uint8_t worst = 0;
+            for (uint8_t i = 1; i < bankCount; i++)
+            {
+                if (bank[i].score < bank[worst].score)
+                    worst = i;
+            }
+            if (found.score > bank[worst].score)
+            {
+                bank[worst] = found;
+                kept = true;
+            }
+        }
+        xSemaphoreGive(bankMutex);
+    }
+    return kept;
+}
+
+static void life_search_load()
+{
+    File file = LittleFS.open(LIFE_SEARCH_FILE, "r");
+    if (!file)
+        return;
+
+    uint8_t header[2];
+    if (file.read(header, sizeof(header)) == sizeof(header) && header[0] == LIFE_SEARCH_VERSION && header[1] <= LIFE_SEARCH_BANK &&
+        file.read((uint8_t *)bank, header[1] * sizeof(life_seed_t)) == header[1] * sizeof(life_seed_t))
+    {
+        bankCount = header[1];
+    }
+    file.close();
+    DB_PRINTF("Life seed bank: %u seeds loaded\r\n", bankCount);
+}
+
+static void life_search_persist()
+{
+    // copy the bank so the flash write doesn't hold up life_search_pick()
+    life_seed_t copy[LIFE_SEARCH_BANK];
+    uint8_t header[2] = {LIFE_SEARCH_VERSION, 0};
+    if (!xSemaphoreTake(bankMutex, portMAX_DELAY))
+        return;
+    header[1] = bankCount;
+    memcpy(copy, bank, bankCount * sizeof(life_seed_t));
+    xSemaphoreGive(bankMutex);
+
+    File file = LittleFS.open(LIFE_SEARCH_FILE, "w");
+    if (!file)
+        return;
+    file.write(header, sizeof(header));
+    file.write((const uint8_t *)copy, header[1] * sizeof(life_seed_t));
+    file.close();
+    DB_PRINTF("Life seed bank: %u seeds saved\r\n", header[1]);
+}
+
+// ----- Soup search task (Core 0) -----
+void searchTask(void *pvParameters)
+{
+    life_t *board = life_create(NUM_COLS, NUM_ROWS, false);
+    if (!board)
+    {
+        searchTaskHandle = NULL;
+        vTaskDelete(NULL);
+        return;
+    }
+
+    unsigned long lastPersist = millis();
+    bool dirty = false;
+    while (true)
+    {
+        unsigned long start = micros();
+
+        life_seed_t found;
+        found.seed = esp_random();
+        found.lifetime = life_search_run(board, found.seed, found.score);
+        if (found.lifetime >= LIFE_SEARCH_MIN_LIFETIME && life_search_keep(found))
+        {
+            DB_PRINTF("Life seed %08x: lifetime %u score %u\r\n", (unsigned)found.seed, found.lifetime, (unsigned)found.score);
+            dirty = true;
+        }
+
+        if (dirty && millis() - lastPersist >= LIFE_SEARCH_PERSIST_MILLIS)
+        {
+            life_search_persist();
+            lastPersist = millis();
+            dirty = false;
+        }
+
+        // keep to LIFE_SEARCH_SHARE of the core: sleep (100 - share) / share times as long as the soup took
+        unsigned long busy = (micros() - start) / 1000;
+        unsigned long rest = busy * (100 - LIFE_SEARCH_SHARE) / LIFE_SEARCH_SHARE;
+        vTaskDelay(pdMS_TO_TICKS(rest > LIFE_SEARCH_MIN_DELAY ? rest : LIFE_SEARCH_MIN_DELAY));
+    }
+}
+
+void life_search_setup()
+{
+    bankMutex = xSemaphoreCreateMutex();
+    if (LittleFS.begin(false))
+        life_search_load();
+
+    // below the physics and LED output tasks so it only gets what they leave
+    DB_PRINTLN("Creating soup search task");
+    xTaskCreatePinnedToCore(searchTask, "searchTask", 8192, NULL, tskIDLE_PRIORITY, &searchTaskHandle, 0);
+}
+
+bool life_search_pick(life_seed_t &seed)
+{
+    // never wait on the search task
+    if (!bankMutex || !xSemaphoreTake(bankMutex, 0))
+        return false;
+
+    bool found = bankCount > 0;
+    if (found)
+        seed = bank[random16(bankCount)];
+    xSemaphoreGive(bankMutex);
+    return found;
+}
@@ -0,0 +1,29 @@
+#ifndef LIFESEARCH_H
+#define LIFESEARCH_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+//
+// Soup search: a low priority task on core 0 evolves random soups on a bounded board the
+// size of the matrix and keeps the ones that run the longest and change the most in a
+// seed bank in LittleFS. A soup is regenerated from its 32 bit seed so the bank is tiny.
+//
+
+typedef struct
+{
+    uint32_t seed;     // the soup (see life_search_soup())
+    uint16_t lifetime; // generations before it settled down
+    uint32_t score;    // cells that changed over its lifetime
+} life_seed_t;
+
+// load the seed bank and start the search task
+void life_search_setup();
+
+// pick a random seed from the bank, false if it is empty
+bool life_search_pick(life_seed_t &seed);
+
+// fill the rows of a width x height board with the soup of a seed (in the middle of it)
+void life_search_soup(uint32_t seed, uint32_t *rows, size_t width, size_t height);
+
+#endif // LIFESEARCH_H
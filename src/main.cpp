@@ -2,6 +2,8 @@
 #include "debug.h"
 #include "settings.h"
 #include "modes.h"
+#include "render.h"
+#include "lifesearch.h"
 
 #ifdef WIFI
 #include "WiFiHelpers.h"
@@ -11,25 +13,31 @@
 #include <ArduinoJson.h>
 #endif // REST
 
+#endif // WIFI
+
 #ifdef TIME
 #include "RealTimeClock.h"
 #endif // TIME
 
-#endif // WIFI
+#ifdef BENCHMARK
+#include "benchmark.h"
+#endif // BENCHMARK
 
 //
 // GLOBAL PIN DECLARATIONS -------------------------------------------------
 //
-// setup our LED strips for parallel output using FastLED
+// setup our LED strips for parallel output using FastLED (NUM_STRIPS of these are used)
+// GPIO 25 doesn't exist on the ESP32-S3 and 26-32 are taken by the flash/PSRAM so
+// the extra strips use the free pins next to GPIO 18 on the DevKitC-1 header
 #define LED_STRIP_PIN_1 18
-#define LED_STRIP_PIN_2 27
-#define LED_STRIP_PIN_3 26
-#define LED_STRIP_PIN_4 25
+#define LED_STRIP_PIN_2 17
+#define LED_STRIP_PIN_3 16
+#define LED_STRIP_PIN_4 15
 #define LED_TYPE WS2812B
 #define COLOR_ORDER GRB
 
 #ifdef REST
-// update the FastLED brightness
+// update the brightness
 void setBrightness(int brightness)
 {
   // constrain our total brightness from MIN_BRIGHTNESS to MAX_BRIGHTNESS so it doesn't get too dark
@@ -41,7 +49,7 @@ void setBrightness(int brightness)
     settings.brightness = newBrightness;
     DB_PRINTF("new brightness = %d\r\n", settings.brightness);
 
-    FastLED.setBrightness(dim8_raw(settings.brightness));
+    // render_show() rebuilds its output table for the new brightness
     leds_dirty = true;
   }
 }
@@ -219,11 +227,33 @@ void setup()
   // initialize the random number generator using the ESP32 hardware RNG
   randomSeed(esp_random());
 
-  // intialize the LED strips for parallel output
-  FastLED.addLeds<LED_TYPE, LED_STRIP_PIN_1, COLOR_ORDER>(leds + 0 * NUM_LEDS_PER_STRIP, NUM_LEDS_PER_STRIP).setCorrection(TypicalLEDStrip);
-  FastLED.setBrightness(dim8_raw(settings.brightness));
+  // intialize the LED strips for parallel output, strip n shows rows StripRows.firstRow[n]...
+  FastLED.addLeds<LED_TYPE, LED_STRIP_PIN_1, COLOR_ORDER>(physical_leds[0] + 0 * NUM_LEDS_PER_STRIP, NUM_LEDS_PER_STRIP).setCorrection(UncorrectedColor);
+#if NUM_STRIPS > 1
+  FastLED.addLeds<LED_TYPE, LED_STRIP_PIN_2, COLOR_ORDER>(physical_leds[0] + 1 * NUM_LEDS_PER_STRIP, NUM_LEDS_PER_STRIP).setCorrection(UncorrectedColor);
+#endif
+#if NUM_STRIPS > 2
+  FastLED.addLeds<LED_TYPE, LED_STRIP_PIN_3, COLOR_ORDER>(physical_leds[0] + 2 * NUM_LEDS_PER_STRIP, NUM_LEDS_PER_STRIP).setCorrection(UncorrectedColor);
+#endif
+#if NUM_STRIPS > 3
+  FastLED.addLeds<LED_TYPE, LED_STRIP_PIN_4, COLOR_ORDER>(physical_leds[0] + 3 * NUM_LEDS_PER_STRIP, NUM_LEDS_PER_STRIP).setCorrection(UncorrectedColor);
+#endif
+  // brightness and color correction are applied by render_show() (see OUTPUT_CORRECTION)
+  FastLED.setBrightness(255);
+  FastLED.setDither(DISABLE_DITHER);
   leds_dirty = true;
 
+  // FastLED.show() runs on its own task so rendering overlaps the transmission
+  render_setup();
+
+  // evolve random Life soups on core 0 while it would otherwise be idle
+  life_search_setup();
+
+#ifdef BENCHMARK
+  // time every mode before the first frame is shown
+  benchmark_run();
+#endif // BENCHMARK
+
   // re-set the mode to ensure proper initialization
   int mode = settings.mode;
   settings.mode = -1; // force a change
@@ -250,8 +280,7 @@ void loop()
   drawClock();
 #endif // TIME
 
-  // if we have changes in the LEDs, show the updated frame
-  //  if (leds_dirty)
+  // show the updated frame (render_show() skips frames that haven't changed)
   {
 #ifdef DEBUG_SPINNER
     static const char *spinner = "|/-\\";
@@ -265,17 +294,19 @@ void loop()
     static uint16_t frames = 0;
     frames++;
 
-    // Once per second, print FPS
+    // Once per second, print FPS and how many frames actually went out to the LEDs
     EVERY_N_MILLISECONDS(1000)
     {
-      Serial.print("FPS: ");
-      Serial.println(frames);
+      static render_stats_t lastStats = {0, 0};
+      render_stats_t stats = render_get_stats();
+      Serial.printf("FPS: %u shown: %u skipped: %u\r\n", frames, stats.shown - lastStats.shown, stats.skipped - lastStats.skipped);
+      lastStats = stats;
       frames = 0;
     }
 #endif // DEBUG_FPS
 
     leds_dirty = false; // clear the dirty flag before showing the frame or changes via asyncronous REST calls will fail to be drawn
-    FastLED.show();
+    render_show();
   }
 
   // persist any changes to the settings
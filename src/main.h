@@ -4,7 +4,12 @@
 #include <Arduino.h>
 
 // don't include components that require WiFi unless it is included
+// (the native host build has no WiFi but keeps the clock, see lib/native)
+#ifndef NATIVE
 #define WIFI
+#else
+#define TIME
+#endif
 #ifdef WIFI
 #define DRD
 #define OTA
@@ -15,6 +20,9 @@
 //#define SPIFFSEDITOR
 #endif
 
+// print a table of frame times for every mode at startup (see benchmark.h)
+//#define BENCHMARK
+
 // update the FastLED brightness based on our ambient and manual settings only if requested (using the right knob)
 #define MIN_BRIGHTNESS 32  // the minimum brightness we want (above zero so it doesn't go completely dark)
 #define MAX_BRIGHTNESS 255 // the max possible brightness
@@ -2,6 +2,10 @@
 #include "debug.h"
 #include "settings.h"
 #include "modes.h"
+#include "render.h"
+#include "displaylist.h"
+#include "benchmark.h"
+#include "physics.h"
 
 #include "MarbleMadness.h"
 #include "bounce.h"
@@ -12,7 +16,7 @@
 #include "pachinko.h"
 #include "physicsRoller.h"
 #include "XYfire.h"
-#include "xymatrix.h"
+#include "XYmatrix.h"
 #include "connect4.h"
 
 #ifdef TIME
@@ -34,7 +38,7 @@ struct MarbleMadnessMode
 
 // This look up table lists each of the display/animation drawing functions
 MarbleMadnessMode MarbleMadnessLUT[]{
-    {NULL, mode_marbleroller, NULL, "MarbleRoller", true},
+    {marbleroller_enter, mode_marbleroller, NULL, "MarbleRoller", true},
     {marbletrack_enter, marbletrack_loop, NULL, "MarbleTrack", true},
     {physicsRoller_enter, physicsRoller_loop, physicsRoller_leave, "PhysicsRoller", true},
     {ringer_enter, ringer_loop, ringer_leave, "Ringer", true},
@@ -52,8 +56,48 @@ MarbleMadnessMode MarbleMadnessLUT[]{
 };
 uint8_t marblemadnessModes = (sizeof(MarbleMadnessLUT) / sizeof(MarbleMadnessLUT[0])); // total number of valid modes in table
 
+// Mode changes can be requested from the REST handlers which run on another task.
+// They are only recorded here and applied by the render loop so enter/exit functions
+// never run while a mode is in the middle of drawing a frame.
+static volatile int requestedMode = -1;
+
+static void applyMarbleMadnessMode(int x)
+{
+    // if the mode changed
+    if (settings.mode != x)
+    {
+        // call the exit function for the old mode iff it is valid
+        if (settings.mode >= 0 && settings.mode < marblemadnessModes && MarbleMadnessLUT[settings.mode].exitFunc)
+        {
+            (*MarbleMadnessLUT[settings.mode].exitFunc)();
+        }
+
+        // output the new mode name, transition from the old mode's last frame and clear the frame buffer for the new mode
+        settings.mode = x;
+        DB_PRINTF("setMarbleMadnessMode: %s\r\n", MarbleMadnessLUT[settings.mode].modeName);
+        set_transition(RANDOM, leds);
+        frame_clear();
+        dl_reset();
+        leds_dirty = true;
+
+        // call the enter function for the new mode if it exists
+        if (MarbleMadnessLUT[x].enterFunc)
+        {
+            (*MarbleMadnessLUT[x].enterFunc)();
+        }
+    }
+}
+
 void marbleMadnessModeRender()
 {
+    // switch modes if one was requested since the last frame
+    int mode = requestedMode;
+    if (mode >= 0)
+    {
+        requestedMode = -1;
+        applyMarbleMadnessMode(mode);
+    }
+
     // call the render function for the current mode
     (*MarbleMadnessLUT[settings.mode].renderFunc)();
 }
@@ -64,27 +108,8 @@ void setMarbleMadnessMode(const char *newMode)
     {
         if (String(MarbleMadnessLUT[x].modeName).equalsIgnoreCase(newMode))
         {
-            // if the mode changed
-            if (settings.mode != x)
-            {
-                // call the exit function for the old mode iff it is valid
-                if (settings.mode >= 0 && settings.mode < marblemadnessModes && MarbleMadnessLUT[settings.mode].exitFunc)
-                {
-                    (*MarbleMadnessLUT[settings.mode].exitFunc)();
-                }
-
-                // output the new mode name and clear the led strips for the new mode
-                settings.mode = x;
-                DB_PRINTF("setMarbleMadnessMode: %s\r\n", MarbleMadnessLUT[settings.mode].modeName);
-                FastLED.clear(true);
-                leds_dirty = true;
-
-                // call the enter function for the new mode if it exists
-                if (MarbleMadnessLUT[x].enterFunc)
-                {
-                    (*MarbleMadnessLUT[x].enterFunc)();
-                }
-            }
+            // applied by the next marbleMadnessModeRender()
+            requestedMode = x;
             break;
         }
     }
@@ -106,6 +131,65 @@ bool getMarbleMadnessModeShowInRESTAPI(int mode)
     return MarbleMadnessLUT[mode].showInRESTAPI;
 }
 
+// Time every mode for the benchmark (see benchmark.h)
+void benchmarkMarbleMadnessModes(uint16_t frames)
+{
+    static uint32_t samples[BENCHMARK_MAX_FRAMES];
+    static uint32_t stepSamples[BENCHMARK_MAX_FRAMES];
+    if (frames > BENCHMARK_MAX_FRAMES)
+        frames = BENCHMARK_MAX_FRAMES;
+
+    for (int x = 0; x < marblemadnessModes; x++)
+    {
+        const MarbleMadnessMode &mode = MarbleMadnessLUT[x];
+        int32_t heapBefore = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+
+        // the physics modes also time their world steps
+        physicsStepCount = 0;
+        physicsStepCapacity = frames;
+        physicsStepSamples = stepSamples;
+
+        frame_clear();
+        dl_reset();
+        if (mode.enterFunc)
+            (*mode.enterFunc)();
+        int32_t heapInUse = heapBefore - (int32_t)heap_caps_get_free_size(MALLOC_CAP_8BIT);
+
+        // only the calls that draw a frame count, the others are waiting for their EVERY_N_MILLIS() window
+        uint16_t count = 0;
+        unsigned long start = millis();
+        while (count < frames && millis() - start < BENCHMARK_MAX_MILLIS)
+        {
+            leds_dirty = false;
+            int64_t begin = benchmark_micros();
+            (*mode.renderFunc)();
+            int64_t elapsed = benchmark_micros() - begin;
+            if (leds_dirty)
+                samples[count++] = elapsed;
+
+            // let the clock (and the physics task) move on
+            delay(1);
+        }
+
+        if (mode.exitFunc)
+            (*mode.exitFunc)();
+        physicsStepSamples = NULL;
+        int32_t heapLeaked = heapBefore - (int32_t)heap_caps_get_free_size(MALLOC_CAP_8BIT);
+
+        benchmark_report(mode.modeName, samples, count, heapInUse, heapLeaked);
+        if (physicsStepCount)
+        {
+            char name[MAX_MODE_NAME + 10];
+            snprintf(name, sizeof(name), "%s step", mode.modeName);
+            benchmark_report(name, stepSamples, physicsStepCount, 0, 0);
+        }
+    }
+
+    frame_clear();
+    dl_reset();
+    leds_dirty = true;
+}
+
 // All Pixels off
 void mode_off()
 {
@@ -7,6 +7,9 @@ const char *getMarbleMadnessMode(int mode);
 bool getMarbleMadnessModeShowInRESTAPI(int mode);
 void mode_off();
 
+// time every mode in turn (see benchmark.h)
+void benchmarkMarbleMadnessModes(uint16_t frames);
+
 extern uint8_t marblemadnessModes; // total number of valid modes in the LUT
 
 #endif // MODES_H
@@ -1,6 +1,7 @@
 #include "main.h"
 #include "settings.h"
 #include "render.h"
+#include "displaylist.h"
 #include "pachinko.h"
 #include "physics.h"
 #include "debug.h"
@@ -59,16 +60,14 @@ uint32_t pinPattern[HEIGHT] = {
 // ----- Physics setup -----
 static void setupWorld()
 {
-    // create the world
-    b2WorldDef worldDef = b2DefaultWorldDef();
-    worldDef.gravity = (b2Vec2){0.0f, -9.8f};
-    world = b2CreateWorld(&worldDef);
+    // get the (reused) world ready
+    physics_reset((b2Vec2){0.0f, -9.8f});
 
     //    CreateWall((float)WIDTH / 2.0f, -0.125f, (float)WIDTH + 0.5f, 0.25f);             // floor
     CreateWall(-0.5f, (float)HEIGHT / 2.0f, 0.25f, (float)HEIGHT + 2.0f);                  // left wall
     CreateWall((float)WIDTH - 1.0f + 0.5f, (float)HEIGHT / 2.0f, 0.25f, (float)HEIGHT + 2.0f);    // right wall
 
-    // Create pins based on the pinPattern array
+    // Create pins based on the pinPattern array (and draw them on the background layer once)
     for (uint8_t y = 0; y < HEIGHT; y++)
     {
         for (uint8_t x = 0; x < WIDTH; x++)
@@ -78,6 +77,7 @@ static void setupWorld()
             {
                 // The coefficient of restitution (CoR) for a steel pachinko pin typically falls in the range of 0.80 to 0.85.
                 CreateCircle((float)x, (float)(HEIGHT - y), 0.15f, 0.3f, 0.80f, b2_staticBody);
+                dl_point(LAYER_BACKGROUND, x, y, CRGB(0x161616));
             }
         }
     }
@@ -126,54 +126,41 @@ void pachinko_loop()
             CRGB::LimeGreen // Electric and sharp
         };
 
-        // Clear the LED array and redraw the pins
-        FastLED.clear();
-        for (uint8_t y = 0; y < HEIGHT; y++)
-        {
-            for (uint8_t x = 0; x < WIDTH; x++)
-            {
-                if ((pinPattern[y] >> (WIDTH - 1 - x)) & 0x1)
-                {
-                    leds[XY(x, y)] = CRGB(0x161616);
-                }
-            }
-        }
-
         // Draw marbles at their current positions
         bool marblesVisible = false;
+        const physics_snapshot_t *snapshot = physics_snapshot();
+        dl_clear(LAYER_MARBLES);
         for (int i = 0; i < MARBLE_COUNT; ++i)
         {
-            if (!b2Body_IsValid(marbles[i]))
+            b2Vec2 position;
+            if (!physics_position(snapshot, marbles[i], position))
                 continue;
 
-            b2Vec2 position = b2Body_GetPosition(marbles[i]);
+            dl_marble(LAYER_MARBLES, position.x, HEIGHT - position.y, colors[i % (sizeof(colors) / sizeof(colors[0]))]);
+
             int gx = (int)lroundf(position.x);
             int gy = HEIGHT - (int)lroundf(position.y);
-            leds[XY(gx, gy)] = colors[i % (sizeof(colors) / sizeof(colors[0]))];
             if ((gx >= 0 && gx < WIDTH) && (gy >= 0 && gy < HEIGHT))
                 marblesVisible = true;
         }
+        dl_render();
 
         // If no marbles are visible (all have fallen off the bottom), reset their positions
-        if (!marblesVisible)
+        // (once the last reset shows)
+        static uint32_t resetCommand = 0;
+        if (!marblesVisible && snapshot->count && physics_done(resetCommand))
         {
-            // make sure we can get the world mutex before resetting the world
-            if (xSemaphoreTake(worldMutex, portMAX_DELAY))
+            // Move marbles to new random positions on the top row
+            for (int i = 0; i < MARBLE_COUNT; ++i)
             {
-                // Move marbles to new random positions on the top row
-                for (int i = 0; i < MARBLE_COUNT; ++i)
-                {
-                    float x = (float)(random(0, WIDTH));
-                    b2Vec2 newPos = {x, (float)HEIGHT};
-                    b2Body_SetTransform(marbles[i], newPos, b2MakeRot(0.0f)); // Move to new location
-
-                    // Give each an initial push
-                    float vx = (random(-100, 101)) / 50.0f; // ~[-2, 2] m/s
-                    float vy = (random(10, 151)) / 50.0f;   // ~[0.2, 3] m/s upward
-                    b2Body_SetLinearVelocity(marbles[i], (b2Vec2){vx, vy});
-                    b2Body_SetAngularVelocity(marbles[i], 0.0f); // Stop spin
-                }
-                xSemaphoreGive(worldMutex);
+                float x = (float)(random(0, WIDTH));
+                b2Vec2 newPos = {x, (float)HEIGHT};
+                physics_set_transform(marbles[i], newPos); // Move to new location
+
+                // Give each an initial push (and stop any spin)
+                float vx = (random(-100, 101)) / 50.0f; // ~[-2, 2] m/s
+                float vy = (random(10, 151)) / 50.0f;   // ~[0.2, 3] m/s upward
+                resetCommand = physics_set_velocity(marbles[i], (b2Vec2){vx, vy});
             }
         }
 
@@ -1,6 +1,8 @@
 #include "main.h"
 #include "debug.h"
 #include "physics.h"
+#include "benchmark.h"
+#include <atomic>
 
 // ID of the Box2D world instance
 b2WorldId world = B2_NULL_ID;
@@ -9,49 +11,260 @@ b2WorldId world = B2_NULL_ID;
 TaskHandle_t physicsTaskHandle = NULL;
 SemaphoreHandle_t worldMutex = xSemaphoreCreateMutex();
 
-b2BodyId CreateWall(float x, float y, float w, float h)
+uint32_t *physicsStepSamples = NULL;
+uint16_t physicsStepCapacity = 0;
+volatile uint16_t physicsStepCount = 0;
+
+// ----- Body snapshots -----
+// The dynamic bodies the snapshots are taken of (indexed like the snapshots), only
+// touched with the world mutex held
+static b2BodyId snapshotBodies[PHYSICS_MAX_BODIES];
+static uint16_t snapshotCount = 0;
+static uint32_t stepCount = 0;
+
+// Triple buffer: the physics task fills one snapshot while the render loop reads another
+// and the third holds the latest complete one. Publishing and taking a snapshot just swap
+// buffer indices so neither side ever waits on the other.
+static physics_snapshot_t snapshots[3];
+static std::atomic<uint8_t> snapshotLatest(1);
+static uint8_t snapshotBack = 0;  // physics task
+static uint8_t snapshotFront = 2; // render loop
+static uint8_t snapshotPrev = 1;  // the one the physics task published last
+#define SNAPSHOT_FRESH 0x80       // set on snapshotLatest until the render loop takes it
+
+// bodies that move further than this in one step were teleported (b2Body_SetTransform) and aren't interpolated
+#define PHYSICS_TELEPORT 2.0f
+
+// add a dynamic body to the snapshots (call with the world mutex held or before the physics task starts)
+static void physics_track(b2BodyId body)
+{
+    int index = body.index1 - 1;
+    if (index < 0 || index >= PHYSICS_MAX_BODIES)
+    {
+        DB_PRINTF("Body %d won't be in the snapshots (PHYSICS_MAX_BODIES is %d)\r\n", body.index1, PHYSICS_MAX_BODIES);
+        return;
+    }
+    snapshotBodies[index] = body;
+    if (index >= snapshotCount)
+        snapshotCount = index + 1;
+}
+
+// fill the back buffer with the state of the dynamic bodies after the step just taken and
+// publish it (call with the world mutex held)
+static void physics_publish(uint32_t due)
+{
+    physics_snapshot_t &snapshot = snapshots[snapshotBack];
+    const physics_snapshot_t &prev = snapshots[snapshotPrev];
+
+    stepCount++;
+    snapshot.step = stepCount;
+    snapshot.due = due;
+    snapshot.count = snapshotCount;
+    for (int i = 0; i < snapshotCount; ++i)
+    {
+        b2BodyId body = snapshotBodies[i];
+        if (B2_IS_NULL(body) || !b2Body_IsValid(body))
+        {
+            snapshotBodies[i] = B2_NULL_ID;
+            snapshot.flags[i] = 0;
+            continue;
+        }
+
+        b2Transform xf = b2Body_GetTransform(body);
+        b2Vec2 velocity = b2Body_GetLinearVelocity(body);
+        snapshot.flags[i] = PHYSICS_BODY_VALID | (b2Body_IsAwake(body) ? PHYSICS_BODY_AWAKE : 0);
+        snapshot.generation[i] = body.generation;
+        snapshot.x[i] = xf.p.x;
+        snapshot.y[i] = xf.p.y;
+        snapshot.angle[i] = b2Rot_GetAngle(xf.q);
+        snapshot.vx[i] = velocity.x;
+        snapshot.vy[i] = velocity.y;
+
+        // interpolate from where the last snapshot had the body (unless it wasn't there or was teleported)
+        snapshot.prevX[i] = xf.p.x;
+        snapshot.prevY[i] = xf.p.y;
+        if (i < prev.count && prev.flags[i] && prev.generation[i] == body.generation && prev.step == stepCount - 1 &&
+            fabsf(xf.p.x - prev.x[i]) + fabsf(xf.p.y - prev.y[i]) <= PHYSICS_TELEPORT)
+        {
+            snapshot.prevX[i] = prev.x[i];
+            snapshot.prevY[i] = prev.y[i];
+        }
+    }
+
+    // the render loop never reads the back buffer, and the physics task only reads the one it published last
+    snapshotPrev = snapshotBack;
+    snapshotBack = snapshotLatest.exchange(snapshotBack | SNAPSHOT_FRESH) & ~SNAPSHOT_FRESH;
+}
+
+const physics_snapshot_t *physics_snapshot()
+{
+    // take the latest snapshot if one was published since the last call
+    if (snapshotLatest.load() & SNAPSHOT_FRESH)
+        snapshotFront = snapshotLatest.exchange(snapshotFront) & ~SNAPSHOT_FRESH;
+    return &snapshots[snapshotFront];
+}
+
+bool physics_position(const physics_snapshot_t *snapshot, b2BodyId body, b2Vec2 &position)
+{
+    int index = body.index1 - 1;
+    if (index < 0 || index >= snapshot->count || !snapshot->flags[index] || snapshot->generation[index] != body.generation)
+        return false;
+
+    // show the body one step behind, as far from prev to curr as the time since the step was due
+    float alpha = (float)(micros() - snapshot->due) / PHYSICS_STEP_US;
+    if (alpha > 1.0f)
+        alpha = 1.0f;
+    position.x = snapshot->prevX[index] + (snapshot->x[index] - snapshot->prevX[index]) * alpha;
+    position.y = snapshot->prevY[index] + (snapshot->y[index] - snapshot->prevY[index]) * alpha;
+    return true;
+}
+
+bool physics_awake(const physics_snapshot_t *snapshot, b2BodyId body)
+{
+    int index = body.index1 - 1;
+    return index >= 0 && index < snapshot->count && (snapshot->flags[index] & PHYSICS_BODY_AWAKE) && snapshot->generation[index] == body.generation;
+}
+
+// ----- Body pools -----
+// The world outlives the modes: when a mode leaves, its bodies are disabled and kept in
+// these pools, and the next mode's CreateCircle/CreateWall/CreateLine reshape them
+// instead of allocating new ones (only touched with the world mutex held or while the
+// physics task is asleep)
+static b2BodyId circlePool[PHYSICS_MAX_BODIES];
+static b2BodyId wallPool[PHYSICS_MAX_BODIES];
+static int circlePoolCount = 0;
+static int wallPoolCount = 0;
+static b2BodyId bodiesInUse[PHYSICS_MAX_BODIES];
+static int bodiesInUseCount = 0;
+
+// take a body from a pool and move it into place, returns B2_NULL_ID if the pool is empty
+static b2BodyId physics_reuse(b2BodyId *pool, int &poolCount, b2BodyType type, b2Vec2 position, b2ShapeId &shape)
 {
-    // Create the body
-    b2BodyDef bodyDef = b2DefaultBodyDef();
-    bodyDef.position = (b2Vec2){x, y}; // Center of the wall
-    b2BodyId body = b2CreateBody(world, &bodyDef);
+    if (!poolCount)
+        return B2_NULL_ID;
+
+    b2BodyId body = pool[--poolCount];
+    b2Body_Enable(body);
+    b2Body_SetType(body, type);
+    b2Body_SetTransform(body, position, b2MakeRot(0.0f));
+    b2Body_SetLinearVelocity(body, b2Vec2_zero);
+    b2Body_SetAngularVelocity(body, 0.0f);
+    b2Body_GetShapes(body, &shape, 1);
+    return body;
+}
+
+// count a body as part of the current mode, false (and the body is destroyed) if there are too many
+static bool physics_use(b2BodyId body)
+{
+    if (bodiesInUseCount >= PHYSICS_MAX_BODIES)
+    {
+        DB_PRINTF("Too many bodies (PHYSICS_MAX_BODIES is %d)\r\n", PHYSICS_MAX_BODIES);
+        b2DestroyBody(body);
+        return false;
+    }
+    bodiesInUse[bodiesInUseCount++] = body;
+    return true;
+}
+
+// disable a body of the current mode and put it back in its pool
+static void physics_recycle(b2BodyId body)
+{
+    for (int i = 0; i < bodiesInUseCount; ++i)
+    {
+        if (B2_ID_EQUALS(bodiesInUse[i], body))
+        {
+            bodiesInUse[i] = bodiesInUse[--bodiesInUseCount];
+            break;
+        }
+    }
+
+    int index = body.index1 - 1;
+    if (index >= 0 && index < PHYSICS_MAX_BODIES)
+        snapshotBodies[index] = B2_NULL_ID;
 
+    b2ShapeId shape;
+    b2Body_GetShapes(body, &shape, 1);
+    b2Body_Disable(body);
+    if (b2Shape_GetType(shape) == b2_circleShape)
+        circlePool[circlePoolCount++] = body;
+    else
+        wallPool[wallPoolCount++] = body;
+}
+
+b2BodyId CreateWall(float x, float y, float w, float h)
+{
     // Use b2MakeBox to generate the polygon
     b2Polygon box = b2MakeBox(w * 0.5f, h * 0.5f); // half extents
 
-    // Create the shape definition
-    b2ShapeDef shapeDef = b2DefaultShapeDef();
-    shapeDef.material = (b2SurfaceMaterial){
-        .friction = 0.0f,
-        .restitution = 0.0f};
+    // reuse a wall from the pool if there is one
+    b2ShapeId shape;
+    b2BodyId body = physics_reuse(wallPool, wallPoolCount, b2_staticBody, (b2Vec2){x, y}, shape);
+    if (B2_IS_NON_NULL(body))
+    {
+        b2Shape_SetPolygon(shape, &box);
+        b2Shape_SetFriction(shape, 0.0f);
+        b2Shape_SetRestitution(shape, 0.0f);
+    }
+    else
+    {
+        // Create the body
+        b2BodyDef bodyDef = b2DefaultBodyDef();
+        bodyDef.position = (b2Vec2){x, y}; // Center of the wall
+        body = b2CreateBody(world, &bodyDef);
+
+        // Create the shape definition
+        b2ShapeDef shapeDef = b2DefaultShapeDef();
+        shapeDef.material = (b2SurfaceMaterial){
+            .friction = 0.0f,
+            .restitution = 0.0f};
 
-    // Attach the shape to the body
-    b2CreatePolygonShape(body, &shapeDef, &box);
+        // Attach the shape to the body
+        b2CreatePolygonShape(body, &shapeDef, &box);
+    }
+    if (!physics_use(body))
+        return B2_NULL_ID;
     DB_PRINTF("Created wall (x=%.3f,y=%.3f,w=%.3f,h=%.3f)\r\n", x, y, w, h);
     return body;
 }
 
 b2BodyId CreateCircle(float x, float y, float r, float friction, float restitution, b2BodyType type)
 {
-    // Create the body
-    b2BodyDef def = b2DefaultBodyDef();
-    def.type = type;
-    def.position = (b2Vec2){x, y};
-    b2BodyId body = b2CreateBody(world, &def);
-
     // create the circle shape
     b2Circle circle = {0};
     circle.radius = r;
 
-    // Create the shape definition
-    b2ShapeDef shapeDef = b2DefaultShapeDef();
-    shapeDef.density = 5.5f;
-    shapeDef.material = (b2SurfaceMaterial){
-        .friction = friction,
-        .restitution = restitution};
+    // reuse a circle from the pool if there is one
+    b2ShapeId shape;
+    b2BodyId body = physics_reuse(circlePool, circlePoolCount, type, (b2Vec2){x, y}, shape);
+    if (B2_IS_NON_NULL(body))
+    {
+        b2Shape_SetCircle(shape, &circle);
+        b2Shape_SetFriction(shape, friction);
+        b2Shape_SetRestitution(shape, restitution);
+        b2Body_ApplyMassFromShapes(body);
+    }
+    else
+    {
+        // Create the body
+        b2BodyDef def = b2DefaultBodyDef();
+        def.type = type;
+        def.position = (b2Vec2){x, y};
+        body = b2CreateBody(world, &def);
+
+        // Create the shape definition
+        b2ShapeDef shapeDef = b2DefaultShapeDef();
+        shapeDef.density = 5.5f;
+        shapeDef.material = (b2SurfaceMaterial){
+            .friction = friction,
+            .restitution = restitution};
 
-    // Attach the shape to the body
-    b2CreateCircleShape(body, &shapeDef, &circle);
+        // Attach the shape to the body
+        b2CreateCircleShape(body, &shapeDef, &circle);
+    }
+    if (!physics_use(body))
+        return B2_NULL_ID;
+    if (type == b2_dynamicBody)
+        physics_track(body);
     DB_PRINTF("Created circle (x=%.3f,y=%.3f,r=%.3f)\r\n", x, y, r);
     return body;
 }
@@ -74,65 +287,295 @@ b2BodyId CreateLine(float wx1, float wy1, float wx2, float wy2, float thickness,
 
     float angle = atan2f(dy, dx);
 
-    // Create the body at the center with rotation
-    b2BodyDef bodyDef = b2DefaultBodyDef();
-    bodyDef.position = (b2Vec2){cx, cy};
-    b2BodyId body = b2CreateBody(world, &bodyDef);
-
     // Apply local rotation to the polygon (make an offset box)
     b2Polygon rotated = b2MakeOffsetBox(length * 0.5f, thickness * 0.5f, b2Vec2_zero, b2MakeRot(angle));
 
-    // Shape definition
-    b2ShapeDef shapeDef = b2DefaultShapeDef();
-    shapeDef.material = (b2SurfaceMaterial){
-        .friction = friction,
-        .restitution = restitution};
+    // reuse a wall from the pool if there is one (at the center)
+    b2ShapeId shape;
+    b2BodyId body = physics_reuse(wallPool, wallPoolCount, b2_staticBody, (b2Vec2){cx, cy}, shape);
+    if (B2_IS_NON_NULL(body))
+    {
+        b2Shape_SetPolygon(shape, &rotated);
+        b2Shape_SetFriction(shape, friction);
+        b2Shape_SetRestitution(shape, restitution);
+    }
+    else
+    {
+        // Create the body at the center
+        b2BodyDef bodyDef = b2DefaultBodyDef();
+        bodyDef.position = (b2Vec2){cx, cy};
+        body = b2CreateBody(world, &bodyDef);
 
-    // Create polygon shape
-    b2CreatePolygonShape(body, &shapeDef, &rotated);
+        // Shape definition
+        b2ShapeDef shapeDef = b2DefaultShapeDef();
+        shapeDef.material = (b2SurfaceMaterial){
+            .friction = friction,
+            .restitution = restitution};
+
+        // Create polygon shape
+        b2CreatePolygonShape(body, &shapeDef, &rotated);
+    }
+    if (!physics_use(body))
+        return B2_NULL_ID;
 
     DB_PRINTF("Created line world (%.2f,%.2f)-(%.2f,%.2f) len=%.2f angle=%.2f\r\n", wx1, wy1, wx2, wy2, length, angle * 180.0f / M_PI);
 
     return body;
 }
 
+// ----- World commands -----
+enum
+{
+    PHYSICS_SET_TRANSFORM,
+    PHYSICS_SET_VELOCITY,
+    PHYSICS_SET_GRAVITY,
+    PHYSICS_DESTROY_BODY,
+    PHYSICS_CREATE_CIRCLE,
+    PHYSICS_CREATE_LINE,
+};
+
+typedef struct
+{
+    uint8_t type;
+    b2BodyId body;
+    b2Vec2 v;          // position, velocity or gravity (the start of a line)
+    b2Vec2 end;        // the end of a line
+    float f;           // angle, angular velocity or radius
+    float friction, restitution;
+    b2BodyId *created; // where a created body is stored
+} physics_command_t;
+
+// Single producer (the render loop), single consumer (the physics task) ring: each side
+// only writes its own index so neither needs a lock
+static physics_command_t commands[PHYSICS_COMMANDS];
+static std::atomic<uint32_t> commandHead(0); // commands queued
+static std::atomic<uint32_t> commandTail(0); // commands applied
+
+static uint32_t physics_queue(const physics_command_t &command)
+{
+    uint32_t head = commandHead.load(std::memory_order_relaxed);
+    if (head - commandTail.load(std::memory_order_acquire) >= PHYSICS_COMMANDS)
+    {
+        DB_PRINTF("Physics command %d dropped, the queue is full\r\n", command.type);
+        return 0;
+    }
+    commands[head % PHYSICS_COMMANDS] = command;
+    commandHead.store(head + 1, std::memory_order_release);
+    return head + 1;
+}
+
+uint32_t physics_set_transform(b2BodyId body, b2Vec2 position, float angle)
+{
+    physics_command_t command = {};
+    command.type = PHYSICS_SET_TRANSFORM;
+    command.body = body;
+    command.v = position;
+    command.f = angle;
+    return physics_queue(command);
+}
+
+uint32_t physics_set_velocity(b2BodyId body, b2Vec2 velocity, float angularVelocity)
+{
+    physics_command_t command = {};
+    command.type = PHYSICS_SET_VELOCITY;
+    command.body = body;
+    command.v = velocity;
+    command.f = angularVelocity;
+    return physics_queue(command);
+}
+
+uint32_t physics_set_gravity(b2Vec2 gravity)
+{
+    physics_command_t command = {};
+    command.type = PHYSICS_SET_GRAVITY;
+    command.body = B2_NULL_ID;
+    command.v = gravity;
+    return physics_queue(command);
+}
+
+uint32_t physics_destroy_body(b2BodyId body)
+{
+    physics_command_t command = {};
+    command.type = PHYSICS_DESTROY_BODY;
+    command.body = body;
+    return physics_queue(command);
+}
+
+uint32_t physics_create_circle(b2BodyId *created, b2Vec2 position, float r, float friction, float restitution)
+{
+    physics_command_t command = {};
+    command.type = PHYSICS_CREATE_CIRCLE;
+    command.body = B2_NULL_ID;
+    command.v = position;
+    command.f = r;
+    command.friction = friction;
+    command.restitution = restitution;
+    command.created = created;
+    return physics_queue(command);
+}
+
+uint32_t physics_create_line(b2BodyId *created, b2Vec2 from, b2Vec2 to)
+{
+    physics_command_t command = {};
+    command.type = PHYSICS_CREATE_LINE;
+    command.body = B2_NULL_ID;
+    command.v = from;
+    command.end = to;
+    command.created = created;
+    return physics_queue(command);
+}
+
+bool physics_done(uint32_t command)
+{
+    return (int32_t)(commandTail.load(std::memory_order_acquire) - command) >= 0;
+}
+
+// apply the queued commands, returns the new tail to store once the snapshot showing
+// them is published (call with the world mutex held)
+static uint32_t physics_apply()
+{
+    uint32_t tail = commandTail.load(std::memory_order_relaxed);
+    uint32_t head = commandHead.load(std::memory_order_acquire);
+    for (; tail != head; ++tail)
+    {
+        const physics_command_t &command = commands[tail % PHYSICS_COMMANDS];
+
+        // bodies may have been destroyed since the command was queued
+        if (B2_IS_NON_NULL(command.body) && !b2Body_IsValid(command.body))
+            continue;
+        switch (command.type)
+        {
+        case PHYSICS_SET_TRANSFORM:
+            b2Body_SetTransform(command.body, command.v, b2MakeRot(command.f));
+            break;
+        case PHYSICS_SET_VELOCITY:
+            b2Body_SetLinearVelocity(command.body, command.v);
+            b2Body_SetAngularVelocity(command.body, command.f);
+            break;
+        case PHYSICS_SET_GRAVITY:
+            b2World_SetGravity(world, command.v);
+            break;
+        case PHYSICS_DESTROY_BODY:
+            physics_recycle(command.body);
+            break;
+        case PHYSICS_CREATE_CIRCLE:
+            *command.created = CreateCircle(command.v.x, command.v.y, command.f, command.friction, command.restitution);
+            break;
+        case PHYSICS_CREATE_LINE:
+            *command.created = CreateLine(command.v.x, command.v.y, command.end.x, command.end.y);
+            break;
+        }
+    }
+    return tail;
+}
+
 // ----- Physics task (Core 0) -----
+// The task and the world are made by the first physics mode and kept, the task sleeps
+// while no physics mode is running
+static volatile bool physicsActive = false;
+static SemaphoreHandle_t physicsWake = xSemaphoreCreateBinary();
+
 void physicsTask(void *pvParameters)
 {
-    const TickType_t delay = pdMS_TO_TICKS(1000 / 60); // 60Hz
+    // Fixed time steps: the time since the last wake up is added to the accumulator and
+    // taken out a step at a time, so the world runs at PHYSICS_HZ whatever the step costs
+    TickType_t wake = xTaskGetTickCount();
+    uint32_t last = micros();
+    uint32_t accumulator = PHYSICS_STEP_US;
     while (true)
     {
-        // wait until we get the world mutex
-        if (xSemaphoreTake(worldMutex, portMAX_DELAY))
+        if (!physicsActive)
         {
-            // then step the world and release the mutex
-            b2World_Step(world, 1.0f / 60.0f, 1);
-            xSemaphoreGive(worldMutex);
-            vTaskDelay(delay);
+            // sleep until physics_enter() and start stepping again from then
+            xSemaphoreTake(physicsWake, portMAX_DELAY);
+            wake = xTaskGetTickCount();
+            last = micros();
+            accumulator = PHYSICS_STEP_US;
+            continue;
         }
+
+        uint32_t now = micros();
+        accumulator += now - last;
+        last = now;
+
+        // after a long stall drop the time the catch up steps can't cover so the work stays bounded
+        if (accumulator > PHYSICS_MAX_STEPS * PHYSICS_STEP_US)
+            accumulator = PHYSICS_MAX_STEPS * PHYSICS_STEP_US;
+
+        while (accumulator >= PHYSICS_STEP_US)
+        {
+            accumulator -= PHYSICS_STEP_US;
+
+            // wait until we get the world mutex (the mode may have left while we waited)
+            if (xSemaphoreTake(worldMutex, portMAX_DELAY))
+            {
+                if (physicsActive)
+                {
+                    // then apply the queued commands, step the world and release the mutex
+                    uint32_t applied = physics_apply();
+                    int64_t start = benchmark_micros();
+                    b2World_Step(world, 1.0f / PHYSICS_HZ, 1);
+                    if (physicsStepSamples && physicsStepCount < physicsStepCapacity)
+                        physicsStepSamples[physicsStepCount++] = benchmark_micros() - start;
+                    physics_publish(now - accumulator);
+                    commandTail.store(applied, std::memory_order_release);
+                }
+                xSemaphoreGive(worldMutex);
+            }
+        }
+
+        // sleep until the next step is due (from now if we are running late)
+        TickType_t ticks = xTaskGetTickCount();
+        if ((int32_t)(ticks - wake) > 0)
+            wake = ticks;
+        vTaskDelayUntil(&wake, pdMS_TO_TICKS((PHYSICS_STEP_US - accumulator + 999) / 1000));
+    }
+}
+
+void physics_reset(b2Vec2 gravity)
+{
+    if (B2_IS_NULL(world))
+    {
+        b2WorldDef worldDef = b2DefaultWorldDef();
+        worldDef.gravity = gravity;
+        world = b2CreateWorld(&worldDef);
+        return;
     }
+
+    // the last mode's bodies are already back in the pools (see physics_leave())
+    b2World_SetGravity(world, gravity);
+    b2World_SetRestitutionCallback(world, NULL);
 }
 
 void physics_enter()
 {
-    // Initializie physics world and start physics task
-    DB_PRINTLN("Creating physics task");
-    xTaskCreatePinnedToCore(physicsTask, "physicsTask", 32768, NULL, 1, &physicsTaskHandle, 0);
+    // start the physics task the first time, wake it up after that
+    if (!physicsTaskHandle)
+    {
+        DB_PRINTLN("Creating physics task");
+        xTaskCreatePinnedToCore(physicsTask, "physicsTask", 32768, NULL, 1, &physicsTaskHandle, 0);
+    }
+    physicsActive = true;
+    xSemaphoreGive(physicsWake);
 }
 
 void physics_leave()
 {
-    if (physicsTaskHandle)
+    if (xSemaphoreTake(worldMutex, portMAX_DELAY))
     {
-        if (xSemaphoreTake(worldMutex, portMAX_DELAY))
-        {
-            vTaskDelete(physicsTaskHandle);
-            physicsTaskHandle = NULL;
-            if (!B2_IS_NULL(world))
-                b2DestroyWorld(world);
-            world = B2_NULL_ID;
-            xSemaphoreGive(worldMutex);
-        }
+        // stop stepping and drop the commands for the old mode
+        physicsActive = false;
+        commandTail.store(commandHead.load());
+
+        // put its bodies back in the pools for the next mode
+        while (bodiesInUseCount)
+            physics_recycle(bodiesInUse[bodiesInUseCount - 1]);
+        for (int i = 0; i < PHYSICS_MAX_BODIES; ++i)
+            snapshotBodies[i] = B2_NULL_ID;
+        snapshotCount = 0;
+        for (int i = 0; i < 3; ++i)
+            snapshots[i].count = 0;
+        xSemaphoreGive(worldMutex);
     }
-    DB_PRINTLN("Leaving physics task");
+    DB_PRINTLN("Leaving physics mode");
 }
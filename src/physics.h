@@ -8,7 +8,7 @@
 #include <box2d/box2d.h>
 
 // Before modifying anything in the physics world, you must take the mutex
-// and release it when done
+// and release it when done (the render loop queues commands instead, see below)
 extern b2WorldId world;
 extern SemaphoreHandle_t worldMutex;
 
@@ -19,7 +19,74 @@ b2BodyId CreateCircle(float x, float y, float r, float friction = 0.3f, float re
 // Create a thin box (polygon) between two points (world coords: bottom-left is 0,0)
 b2BodyId CreateLine(float x1, float y1, float x2, float y2, float thickness = 0.9f, float friction = 0.0f, float restitution = 0.0f);
 
+// Get the world ready for a mode to add its bodies, with the given gravity (the world is
+// made once and reused: bodies the last mode made are recycled by the helpers above)
+void physics_reset(b2Vec2 gravity);
+
+// start stepping the world, and stop and recycle the mode's bodies
 void physics_enter();
 void physics_leave();
 
+// The world is stepped PHYSICS_HZ times a second on a fixed schedule; when the task wakes
+// up late it catches up with at most PHYSICS_MAX_STEPS steps
+#define PHYSICS_HZ 60
+#define PHYSICS_STEP_US (1000000 / PHYSICS_HZ)
+#define PHYSICS_MAX_STEPS 4
+#define PHYSICS_MAX_BODIES 128 // bodies past this aren't in the snapshots
+
+// After every step the physics task publishes the state of the dynamic bodies (those
+// made with CreateCircle()) as a snapshot, indexed by b2BodyId.index1 - 1. The render
+// loop reads the snapshots instead of the world, so it doesn't need the world mutex and
+// never waits on a step.
+#define PHYSICS_BODY_VALID 1 // a dynamic body is at this index
+#define PHYSICS_BODY_AWAKE 2 // and it hasn't come to rest
+
+typedef struct
+{
+    uint32_t step;  // steps taken in the world when the snapshot was taken
+    uint32_t due;   // when that step was due (micros())
+    uint16_t count; // indices in use
+    uint8_t flags[PHYSICS_MAX_BODIES];
+    uint16_t generation[PHYSICS_MAX_BODIES]; // b2BodyId.generation of the body at the index
+    float x[PHYSICS_MAX_BODIES], y[PHYSICS_MAX_BODIES];
+    float angle[PHYSICS_MAX_BODIES];
+    float vx[PHYSICS_MAX_BODIES], vy[PHYSICS_MAX_BODIES];
+    float prevX[PHYSICS_MAX_BODIES], prevY[PHYSICS_MAX_BODIES]; // where the body was a step before
+} physics_snapshot_t;
+
+// The latest snapshot. Only the render loop may call this, the snapshot stays unchanged
+// until it calls it again.
+const physics_snapshot_t *physics_snapshot();
+
+// Where a body is right now, interpolated between its positions before and after the
+// step of the snapshot (so it runs a step behind the world), false if it isn't in it
+bool physics_position(const physics_snapshot_t *snapshot, b2BodyId body, b2Vec2 &position);
+
+// whether a body was still moving in the snapshot
+bool physics_awake(const physics_snapshot_t *snapshot, b2BodyId body);
+
+// The render loop changes the world by queuing commands the physics task applies before
+// its next step, so it never waits for the world mutex. Each returns the command's
+// sequence number for physics_done(), or 0 if the queue was full and it was dropped.
+#define PHYSICS_COMMANDS 256 // commands that can be queued (a power of 2)
+
+uint32_t physics_set_transform(b2BodyId body, b2Vec2 position, float angle = 0.0f);
+uint32_t physics_set_velocity(b2BodyId body, b2Vec2 velocity, float angularVelocity = 0.0f);
+uint32_t physics_set_gravity(b2Vec2 gravity);
+uint32_t physics_destroy_body(b2BodyId body); // (it goes back to the pool)
+
+// create a marble or line (see CreateCircle() and CreateLine()), the new body is stored
+// in *created when the command is applied
+uint32_t physics_create_circle(b2BodyId *created, b2Vec2 position, float r, float friction = 0.3f, float restitution = 0.85f);
+uint32_t physics_create_line(b2BodyId *created, b2Vec2 from, b2Vec2 to);
+
+// whether a command (and every one queued before it) has been applied, physics_snapshot()
+// shows it from then on
+bool physics_done(uint32_t command);
+
+// benchmark hook: while set, the physics task records how long each step took (in us)
+extern uint32_t *physicsStepSamples;
+extern uint16_t physicsStepCapacity;
+extern volatile uint16_t physicsStepCount;
+
 #endif // PHYSICS_H
@@ -0,0 +1,144 @@
+#include "main.h"
+#include "render.h"
+#include "pixelops.h"
+
+// 32 bit loads/stores that are allowed to alias the CRGB bytes
+typedef uint32_t __attribute__((__may_alias__)) word_t;
+
+#define EVEN_BYTES 0x00FF00FFu
+#define ODD_BYTES 0xFF00FF00u
+
+// The kernels treat a span of pixels as a span of bytes: the bytes that aren't
+// 4 byte aligned at the start and end are done one at a time and everything in
+// between two lanes at a time per multiply (bytes 0 and 2, then bytes 1 and 3).
+// Each 16 bit lane holds at most 255 * 257 so lanes never carry into each other.
+
+// (byte * scale) >> 8 with FastLED's 'fixed' rounding: scale8(i, s) == (i * (s + 1)) >> 8
+static inline uint32_t scale_word(uint32_t w, uint32_t scale_fixed)
+{
+    uint32_t even = (((w & EVEN_BYTES) * scale_fixed) >> 8) & EVEN_BYTES;
+    uint32_t odd = (((w >> 8) & EVEN_BYTES) * scale_fixed) & ODD_BYTES;
+    return even | odd;
+}
+
+// blend8(a, b, amt) == (a * (256 - amt) + b * (amt + 1)) >> 8
+static inline uint32_t blend_word(uint32_t a, uint32_t b, uint32_t amountOfA, uint32_t amountOfB)
+{
+    uint32_t even = (((a & EVEN_BYTES) * amountOfA + (b & EVEN_BYTES) * amountOfB) >> 8) & EVEN_BYTES;
+    uint32_t odd = (((a >> 8) & EVEN_BYTES) * amountOfA + ((b >> 8) & EVEN_BYTES) * amountOfB) & ODD_BYTES;
+    return even | odd;
+}
+
+void pixels_scale(CRGB *pixels, uint16_t count, uint8_t scale)
+{
+    uint8_t *p = (uint8_t *)pixels;
+    uint8_t *end = p + count * sizeof(CRGB);
+    uint32_t scale_fixed = (uint32_t)scale + 1;
+
+    while (p < end && ((uintptr_t)p & 3))
+    {
+        *p = (*p * scale_fixed) >> 8;
+        p++;
+    }
+    for (; p + 4 <= end; p += 4)
+    {
+        *(word_t *)p = scale_word(*(word_t *)p, scale_fixed);
+    }
+    while (p < end)
+    {
+        *p = (*p * scale_fixed) >> 8;
+        p++;
+    }
+}
+
+void pixels_fade(CRGB *pixels, uint16_t count, uint8_t fadeBy)
+{
+    pixels_scale(pixels, count, 255 - fadeBy);
+}
+
+void pixels_blend(CRGB *existing, const CRGB *overlay, uint16_t count, fract8 amountOfOverlay)
+{
+    uint8_t *a = (uint8_t *)existing;
+    const uint8_t *b = (const uint8_t *)overlay;
+    uint8_t *end = a + count * sizeof(CRGB);
+    uint32_t amountOfA = 256 - (uint32_t)amountOfOverlay;
+    uint32_t amountOfB = (uint32_t)amountOfOverlay + 1;
+
+    // the word loop needs both buffers aligned the same way
+    if (((uintptr_t)a & 3) == ((uintptr_t)b & 3))
+    {
+        while (a < end && ((uintptr_t)a & 3))
+        {
+            *a = (*a * amountOfA + *b * amountOfB) >> 8;
+            a++, b++;
+        }
+        for (; a + 4 <= end; a += 4, b += 4)
+        {
+            *(word_t *)a = blend_word(*(word_t *)a, *(const word_t *)b, amountOfA, amountOfB);
+        }
+    }
+    while (a < end)
+    {
+        *a = (*a * amountOfA + *b * amountOfB) >> 8;
+        a++, b++;
+    }
+}
+
+void pixels_fill(CRGB *pixels, uint16_t count, const CRGB &color)
+{
+    // one pixel at a time until a pixel starts on a word boundary
+    uint16_t i = 0;
+    while (i < count && ((uintptr_t)&pixels[i] & 3))
+    {
+        pixels[i++] = color;
+    }
+
+    // then 4 pixels (3 words) at a time
+    if (count - i >= 4)
+    {
+        CRGB pattern[4] = {color, color, color, color};
+        uint32_t words[3];
+        memcpy(words, pattern, sizeof(words));
+        for (; i + 4 <= count; i += 4)
+        {
+            word_t *w = (word_t *)&pixels[i];
+            w[0] = words[0];
+            w[1] = words[1];
+            w[2] = words[2];
+        }
+    }
+
+    while (i < count)
+    {
+        pixels[i++] = color;
+    }
+}
+
+void pixels_scale_scalar(CRGB *pixels, uint16_t count, uint8_t scale)
+{
+    for (uint16_t i = 0; i < count; i++)
+    {
+        pixels[i].nscale8(scale);
+    }
+}
+
+void pixels_fade_scalar(CRGB *pixels, uint16_t count, uint8_t fadeBy)
+{
+    for (uint16_t i = 0; i < count; i++)
+    {
+        pixels[i].fadeToBlackBy(fadeBy);
+    }
+}
+
+void pixels_blend_scalar(CRGB *existing, const CRGB *overlay, uint16_t count, fract8 amountOfOverlay)
+{
+    for (uint16_t i = 0; i < count; i++)
+    {
+        nblend(existing[i], overlay[i], amountOfOverlay);
+    }
+}
+
+void pixels_fill_scalar(CRGB *pixels, uint16_t count, const CRGB &color)
+{
+    fill_solid(pixels, count, color);
+}
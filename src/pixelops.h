@@ -0,0 +1,31 @@
+#ifndef PIXELOPS_H
+#define PIXELOPS_H
+
+#include "render.h" // for CRGB
+
+//
+// Whole-buffer pixel kernels. These give exactly the same results as calling the
+// FastLED per-pixel functions in a loop (see the _scalar versions) but work on the
+// packed RGB bytes four at a time inside a 32 bit word so a full frame fade is ~270
+// multiplies instead of ~1100 calls. Buffers don't need to be aligned.
+//
+
+// scale every pixel by scale/256 (same as pixels[i].nscale8(scale))
+void pixels_scale(CRGB *pixels, uint16_t count, uint8_t scale);
+
+// fade every pixel toward black (same as pixels[i].fadeToBlackBy(fadeBy))
+void pixels_fade(CRGB *pixels, uint16_t count, uint8_t fadeBy);
+
+// blend overlay into existing (same as nblend(existing[i], overlay[i], amountOfOverlay))
+void pixels_blend(CRGB *existing, const CRGB *overlay, uint16_t count, fract8 amountOfOverlay);
+
+// set every pixel to color (same as fill_solid(pixels, count, color))
+void pixels_fill(CRGB *pixels, uint16_t count, const CRGB &color);
+
+// reference implementations built on the FastLED per-pixel functions
+void pixels_scale_scalar(CRGB *pixels, uint16_t count, uint8_t scale);
+void pixels_fade_scalar(CRGB *pixels, uint16_t count, uint8_t fadeBy);
+void pixels_blend_scalar(CRGB *existing, const CRGB *overlay, uint16_t count, fract8 amountOfOverlay);
+void pixels_fill_scalar(CRGB *pixels, uint16_t count, const CRGB &color);
+
+#endif // PIXELOPS_H
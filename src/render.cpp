@@ -2,209 +2,331 @@
 #include "debug.h"
 #include "settings.h"
 #include "render.h"
+#include "displaylist.h"
 
 // With parallel updates for the LEDs so fast, we get flickering if we call
 // FastLED.Show every loop. Maintain a 'dirty' bit so we know when to call Show.
 boolean leds_dirty = true;
 
-// led array which will be displayed
+// row-major frame buffer the modes draw into
 // have one unused space that we an return when something is out of bounds to make exception handling simpler
-CRGB leds[NUM_LEDS + 1];
+// (word aligned so the pixelops kernels can work a word at a time)
+alignas(4) CRGB leds[NUM_LEDS + 1];
 
-#define BOTTOM_RIGHT
+// led arrays in strip wiring order which will be displayed (plus the hidden pixel)
+alignas(4) CRGB physical_leds[NUM_PHYSICAL_FRAMES][NUM_PHYSICAL_LEDS + 1];
 
-uint16_t XY(uint16_t x, uint16_t y)
+// ----- LED output task (Core 0) -----
+// Pushing 361 WS2812B pixels takes ~11ms. Rather than stalling the render loop for
+// all of that, FastLED.show() runs on the other core. Physical frames are handed back
+// and forth through two queues so the frame being transmitted is never written to.
+static QueueHandle_t freeFrames = NULL;  // frames the render loop can convert into
+static QueueHandle_t readyFrames = NULL; // frames waiting to be shown
+static TaskHandle_t outputTaskHandle = NULL;
+
+static void outputTask(void *pvParameters)
+{
+    uint8_t frame;
+    while (true)
+    {
+        if (xQueueReceive(readyFrames, &frame, portMAX_DELAY))
+        {
+            // point each strip at its slice of the frame and send it
+            for (int strip = 0; strip < FastLED.count(); strip++)
+            {
+                FastLED[strip].setLeds(physical_leds[frame] + strip * NUM_LEDS_PER_STRIP, NUM_LEDS_PER_STRIP);
+            }
+            FastLED.show();
+
+            // the frame can now be reused
+            xQueueSend(freeFrames, &frame, portMAX_DELAY);
+        }
+    }
+}
+
+void render_setup()
+{
+    freeFrames = xQueueCreate(NUM_PHYSICAL_FRAMES, sizeof(uint8_t));
+    readyFrames = xQueueCreate(NUM_PHYSICAL_FRAMES, sizeof(uint8_t));
+    for (uint8_t frame = 0; frame < NUM_PHYSICAL_FRAMES; frame++)
+    {
+        xQueueSend(freeFrames, &frame, 0);
+    }
+
+    // loop() runs on core 1 so transmit from core 0
+    DB_PRINTLN("Creating LED output task");
+    xTaskCreatePinnedToCore(outputTask, "outputTask", 4096, NULL, 2, &outputTaskHandle, 0);
+}
+
+void frame_clear()
+{
+    memset(leds, 0, sizeof(CRGB) * NUM_LEDS);
+}
+
+// ----- output stage -----
+// Brightness, gamma and color correction are folded into one table per channel which is
+// applied while the frame is converted to wiring order. FastLED is left at full brightness
+// with no correction or dithering so show() just streams the bytes. The table is only
+// rebuilt (on the render loop) when the brightness setting changes.
+static uint8_t outputLUT[3][256];
+static int outputBrightness = -1; // the settings.brightness the table was built for
+static uint32_t outputVersion = 0; // changes whenever the table does
+
+static void build_output_lut()
+{
+    uint8_t brightness = dim8_raw(settings.brightness);
+    CRGB correction = OUTPUT_CORRECTION;
+
+    for (uint8_t channel = 0; channel < 3; channel++)
+    {
+        // combine the brightness and correction the same way FastLED does
+        uint8_t scale = ((correction.raw[channel] + 1) * (uint16_t)brightness) >> 8;
+        for (uint16_t value = 0; value < 256; value++)
+        {
+            uint8_t corrected = value;
+            if (OUTPUT_GAMMA != 1.0f)
+                corrected = lroundf(powf(value / 255.0f, OUTPUT_GAMMA) * 255.0f);
+            outputLUT[channel][value] = scale8(corrected, scale);
+        }
+    }
+
+    outputBrightness = settings.brightness;
+    outputVersion++;
+    DB_PRINTF("Output table rebuilt for brightness %d\r\n", outputBrightness);
+}
+
+// counters for render_get_stats()
+static render_stats_t stats = {0, 0};
+
+// hash of the last frame handed to the output task
+static uint32_t shownHash = 0;
+static bool shownHashValid = false;
+
+// FNV-1a over 32 bit words of the frame buffer (with the output table version mixed in
+// as the seed). Much cheaper than a show, and unlike the leds_dirty flag it can't be raced
+// by a REST handler clearing or setting the flag while a frame is being built.
+static uint32_t frame_hash(const CRGB *frame, uint32_t seed)
 {
-  // any out of bounds address maps to the hidden pixel
-  if ((x < 0) || (x >= NUM_COLS) || (y < 0) || (y >= NUM_ROWS))
-    return OUTOFBOUNDS;
-
-  // Calculate the LED index based on a serpintine mapping
-#ifdef BOTTOM_RIGHT
-  // (0,0) is top left (index 360), (18,18) is bottom right (index = 0)
-  // each strip is a single row of the XY matrix
-  int base_index;
-
-  if (y % 2 == 0)
-  {
-    // Even row: right to left
-    base_index = y * NUM_COLS + x;
-  }
-  else
-  {
-    // Odd row: left to right
-    base_index = y * NUM_COLS + (NUM_COLS - 1 - x);
-  }
-
-  // Reverse the index
-  return (NUM_ROWS * NUM_COLS - 1) - base_index;
-#endif // BOTTOM_RIGHT
-#ifdef TOP_LEFT
-  // (0,0) is top left (index 0), (18,18) is bottom right (index = 360)
-  // each strip is a single row of the XY matrix
-  if (y % 2 == 0)
-  {
-    // Even row: left-to-right
-    return y * NUM_COLS + x;
-  }
-  else
-  {
-    // Odd row: right-to-left
-    return y * NUM_COLS + (NUM_COLS - 1 - x);
-  }
-
-  return OUTOFBOUNDS; // should never get here
-#endif                // TOP_LEFT
+    const uint8_t *bytes = (const uint8_t *)frame;
+    const size_t len = sizeof(CRGB) * NUM_LEDS;
+    uint32_t hash = 2166136261u ^ seed;
+    size_t i = 0;
+
+    for (; i + sizeof(uint32_t) <= len; i += sizeof(uint32_t))
+    {
+        uint32_t word;
+        memcpy(&word, bytes + i, sizeof(word));
+        hash = (hash ^ word) * 16777619u;
+    }
+    for (; i < len; i++)
+    {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+render_stats_t render_get_stats()
+{
+    return stats;
+}
+
+void render_show()
+{
+    // pick up brightness changes (usually made from the REST API)
+    if (settings.brightness != outputBrightness)
+        build_output_lut();
+
+    // mid transition, the frame to show is a composite of the old and new modes, and
+    // the overlays (the clock) go on top of that
+    const CRGB *source = dl_present(transition_drawframe());
+
+    // skip the conversion and the ~11ms transmission if nothing visible changed
+    uint32_t hash = frame_hash(source, outputVersion);
+    if (shownHashValid && hash == shownHash)
+    {
+        stats.skipped++;
+        return;
+    }
+
+    // wait for a frame the output task isn't using (only blocks when one frame is
+    // being transmitted and another is already queued behind it)
+    uint8_t frame;
+    if (!xQueueReceive(freeFrames, &frame, portMAX_DELAY))
+        return;
+
+    // single pass from the row-major frame buffer to the corrected colors in the wiring order of the strips
+    CRGB *physical = physical_leds[frame];
+    for (uint16_t i = 0; i < NUM_LEDS; i++)
+    {
+        const CRGB &pixel = source[i];
+        physical[XYLookup.index[i]] = CRGB(outputLUT[0][pixel.r], outputLUT[1][pixel.g], outputLUT[2][pixel.b]);
+    }
+
+    // hand it to the output task
+    xQueueSend(readyFrames, &frame, portMAX_DELAY);
+    shownHash = hash;
+    shownHashValid = true;
+    stats.shown++;
 }
 
-void setLEDBlendClockColor(int x, int y)
+// ----- mode transitions -----
+// When the mode changes, the outgoing frame is kept in transitionFrom and, until the
+// transition finishes, render_show() shows a composite of it and the live frame the
+// new mode is drawing. Each transition is a mask (every pixel has an 'order' 0..255
+// at which it switches to the new frame, blended over a soft edge), an offset gather
+// (the frames are shifted rows/columns) or, for CROSSFADE, one blend of the whole
+// frame, so compositing is one pass over the frame with no per-pixel math beyond a
+// fixed-point blend.
+#define TRANSITION_MILLIS 1000
+
+static TRANSITION_TYPE current_transition = SIMPLE_CUT;
+static bool transitionActive = false;
+static unsigned long transitionStart = 0;
+static CRGB transitionFrom[NUM_LEDS];
+static CRGB transitionFrame[NUM_LEDS];
+static uint8_t transitionMask[NUM_LEDS];
+static uint16_t transitionEdgeScale; // 65536 / width of the soft edge (in mask units)
+static uint8_t transitionEdge;
+
+// fill transitionMask for the mask based transitions
+static void build_transition_mask(TRANSITION_TYPE type)
 {
-    int index = XY(x, y);
-    leds[index] = blend(leds[index], settings.clockColor, 128);
+    transitionEdge = 48;
+    for (uint16_t y = 0; y < NUM_ROWS; y++)
+    {
+        for (uint16_t x = 0; x < NUM_COLS; x++)
+        {
+            uint16_t i = y * NUM_COLS + x;
+            uint8_t order = 0;
+            switch (type)
+            {
+            case MARBLE_ROLLER:
+                // new marbles enter at the end of the strips and roll toward the start
+                if (XYLookup.index[i] < NUM_PHYSICAL_LEDS)
+                    order = (uint32_t)(NUM_PHYSICAL_LEDS - 1 - XYLookup.index[i]) * 255 / (NUM_PHYSICAL_LEDS - 1);
+                break;
+            case ROLL_FROM_LEFT:
+                // one column at a time, each filling from the top
+                order = (uint32_t)(x * NUM_ROWS + y) * 255 / (NUM_LEDS - 1);
+                break;
+            case ROLL_FROM_RIGHT:
+                order = (uint32_t)((NUM_COLS - 1 - x) * NUM_ROWS + y) * 255 / (NUM_LEDS - 1);
+                break;
+            case WIPE:
+                order = x * 255 / (NUM_COLS - 1);
+                break;
+            default:
+                break;
+            }
+            transitionMask[i] = order;
+        }
+    }
+    transitionEdgeScale = 65536 / transitionEdge;
 }
 
-#ifdef COMPLEX_SHAPE
-//
-// I have implemented two different X,Y mapping modes. The first pairs adjacent strips of LEDs into a single x coordinate
-// as they are paired in the triangle columns. The second (WIDERTHANTALLER) maps each strip to a separate x coordinate.
-//
-#define STRIP_0_NUM_COLS 6
-#define STRIP_1_NUM_COLS 4
-#define STRIP_2_NUM_COLS 4
-#define STRIP_3_NUM_COLS 6
-
-int XY(int x, int y)
+void set_transition(TRANSITION_TYPE type, const CRGB *from)
 {
-  const uint8_t XYTable[NUM_ROWS * NUM_COLS / 2] = {
-      //
-      // This array helps translate from a (x,y) coordinate to the correct offset in the leds[] array.
-      // To get the best visual results, we are combining columns as the triangles are interleaved
-      // vertically. This gives us an effective resolution of (20 x 39) pixels with missing corners
-      // where the hexaqgon shape doesn't fill the square. Any (x, y) coordinates that aren't valid
-      // LED positions, return a value that is within the leds[] array but doesn't have a corresponding
-      // physical LED to make error handling simpler.
-      //
-      255, 255, 255, 255, 255, 255, 255, 255, 255, 19,
-      255, 255, 255, 255, 255, 255, 255, 255, 57, 20,
-      255, 255, 255, 255, 255, 255, 255, 93, 58, 18,
-      255, 255, 255, 255, 255, 255, 127, 94, 56, 21,
-      255, 255, 255, 255, 255, 15, 128, 92, 59, 17,
-      255, 255, 255, 255, 45, 16, 126, 95, 55, 22,
-      255, 255, 255, 73, 46, 14, 129, 91, 60, 16,
-      255, 255, 99, 74, 44, 17, 125, 96, 54, 23,
-      255, 123, 100, 72, 47, 13, 130, 90, 61, 15,
-      145, 124, 98, 75, 43, 18, 124, 97, 53, 24,
-      146, 122, 101, 71, 48, 12, 131, 89, 62, 14,
-      144, 125, 97, 76, 42, 19, 123, 98, 52, 25,
-      147, 121, 102, 70, 49, 11, 132, 88, 63, 13,
-      143, 126, 96, 77, 41, 20, 122, 99, 51, 26,
-      148, 120, 103, 69, 50, 10, 133, 87, 64, 12,
-      142, 127, 95, 78, 40, 21, 121, 100, 50, 27,
-      149, 119, 104, 68, 51, 9, 134, 86, 65, 11,
-      141, 128, 94, 79, 39, 22, 120, 101, 49, 28,
-      150, 118, 105, 67, 52, 8, 135, 85, 66, 10,
-      140, 129, 93, 80, 38, 23, 119, 102, 48, 29,
-      151, 117, 106, 66, 53, 7, 136, 84, 67, 9,
-      139, 130, 92, 81, 37, 24, 118, 103, 47, 30,
-      152, 116, 107, 65, 54, 6, 137, 83, 68, 8,
-      138, 131, 91, 82, 36, 25, 117, 104, 46, 31,
-      153, 115, 108, 64, 55, 5, 138, 82, 69, 7,
-      137, 132, 90, 83, 35, 26, 116, 105, 45, 32,
-      154, 114, 109, 63, 56, 4, 139, 81, 70, 6,
-      136, 133, 89, 84, 34, 27, 115, 106, 44, 33,
-      155, 113, 110, 62, 57, 3, 140, 80, 71, 5,
-      135, 134, 88, 85, 33, 28, 114, 107, 43, 34,
-      255, 112, 111, 61, 58, 2, 141, 79, 72, 4,
-      255, 255, 87, 86, 32, 29, 113, 108, 42, 35,
-      255, 255, 255, 60, 59, 1, 142, 78, 73, 3,
-      255, 255, 255, 255, 31, 30, 112, 109, 41, 36,
-      255, 255, 255, 255, 255, 0, 143, 77, 74, 2,
-      255, 255, 255, 255, 255, 255, 111, 110, 40, 37,
-      255, 255, 255, 255, 255, 255, 255, 76, 75, 1,
-      255, 255, 255, 255, 255, 255, 255, 255, 39, 38,
-      255, 255, 255, 255, 255, 255, 255, 255, 255, 0};
-
-  // Compute the index into the lookup table taking into account the fact that the table
-  // only contains 1/2 the columns to save space. The right have are just mirrored from
-  // the left half.
-  uint16_t tableIndex = (y * NUM_COLS / 2);
-  if (x < NUM_COLS / 2)
-  {
-    tableIndex += x;
-  }
-  else
-  {
-    tableIndex += NUM_COLS - x - 1;
-  }
-  uint16_t stripOffset = XYTable[tableIndex];
-  uint8_t strip = 0;
-
-  // if we are returning an out of bounds value for an individual strip, return the first hidden LED instead
-  // to make error handling easier.
-  if (stripOffset >= NUM_LEDS_PER_STRIP)
-    return OUTOFBOUNDS;
-
-  if (x < STRIP_0_NUM_COLS)
-  {
-    strip = 0;
-  }
-  else if (x < STRIP_0_NUM_COLS + STRIP_1_NUM_COLS)
-  {
-    strip = 1;
-  }
-  else if (x < STRIP_0_NUM_COLS + STRIP_1_NUM_COLS + STRIP_2_NUM_COLS)
-  {
-    strip = 2;
-  }
-  else if (x < STRIP_0_NUM_COLS + STRIP_1_NUM_COLS + STRIP_2_NUM_COLS + STRIP_3_NUM_COLS)
-  {
-    strip = 3;
-  }
-
-  return strip * NUM_LEDS_PER_STRIP + stripOffset;
+    // pick a real transition (SIMPLE_CUT isn't much of a transition)
+    if (type == RANDOM)
+    {
+        do
+        {
+            type = (TRANSITION_TYPE)random8(RANDOM);
+        } while (type == SIMPLE_CUT);
+    }
+    current_transition = type;
+
+    if (type == SIMPLE_CUT)
+    {
+        transitionActive = false;
+        return;
+    }
+
+    // if a transition is still running, start from what is on the LEDs rather than the old mode
+    memcpy(transitionFrom, transitionActive ? transitionFrame : from, sizeof(transitionFrom));
+    if (type != SLIDE && type != PUSH && type != FALL && type != CROSSFADE)
+        build_transition_mask(type);
+    transitionStart = millis();
+    transitionActive = true;
 }
-#endif // COMPLEX_SHAPE
 
-#if 0
-TRANSITION_TYPE current_transition = RANDOM;
-CRGB *source_frame;
-void set_transition(TRANSITION_TYPE type, CRGB *leds
+// mix two pixels, amountOfTo is 0..256
+static inline CRGB mix(const CRGB &from, const CRGB &to, uint16_t amountOfTo)
 {
-  current_transition = type;
-  source_frame = leds
+    uint16_t amountOfFrom = 256 - amountOfTo;
+    return CRGB((from.r * amountOfFrom + to.r * amountOfTo) >> 8,
+                (from.g * amountOfFrom + to.g * amountOfTo) >> 8,
+                (from.b * amountOfFrom + to.b * amountOfTo) >> 8);
 }
 
-void transition_drawframe()
+const CRGB *transition_drawframe()
 {
-  switch (current_transition)
-  {
-  case MARBLE_ROLLER:
-    marbleroller_drawframe();
-    break;
-  case ROLL_FROM_LEFT:
-    rollfromleft_drawframe();
-    break;
-  case ROLL_FROM_RIGHT:
-    rollfromright_drawframe();
-    break;
-  case SIMPLE_CUT:
-    simplecut_drawframe();
-    break;
-  case CROSSFADE:
-    crossfade_drawframe();
-    break;
-  case SLIDE:
-    slide_drawframe();
-    break;
-  case WIPE:
-    wipe_drawframe();
-    break;
-  case PUSH:
-    push_drawframe();
-    break;
-  case FALL:
-    fall_drawframe();
-    break;
-  }
+    if (!transitionActive)
+        return leds;
+
+    unsigned long elapsed = millis() - transitionStart;
+    if (elapsed >= TRANSITION_MILLIS)
+    {
+        transitionActive = false;
+        return leds;
+    }
+
+    // progress through the transition as a 0.16 fixed point fraction
+    uint16_t progress = elapsed * 65536 / TRANSITION_MILLIS;
+
+    switch (current_transition)
+    {
+    case SLIDE:
+    case PUSH:
+    {
+        // the new frame comes in from the left, PUSH also moves the old one out to the right
+        uint16_t shift = ((uint32_t)progress * NUM_COLS) >> 16;
+        for (uint16_t y = 0; y < NUM_ROWS; y++)
+        {
+            CRGB *dst = &transitionFrame[y * NUM_COLS];
+            const CRGB *from = &transitionFrom[y * NUM_COLS];
+            memcpy(dst, frame_row(y) + NUM_COLS - shift, sizeof(CRGB) * shift);
+            if (current_transition == PUSH)
+                memcpy(dst + shift, from, sizeof(CRGB) * (NUM_COLS - shift));
+            else
+                memcpy(dst + shift, from + shift, sizeof(CRGB) * (NUM_COLS - shift));
+        }
+        break;
+    }
+    case CROSSFADE:
+    {
+        // every pixel at once, blended evenly over the whole transition
+        uint16_t amount = progress >> 8;
+        for (uint16_t i = 0; i < NUM_LEDS; i++)
+            transitionFrame[i] = mix(transitionFrom[i], leds[i], amount);
+        break;
+    }
+    case FALL:
+    {
+        // the new frame drops in from the top over the old one
+        uint16_t shift = ((uint32_t)progress * NUM_ROWS) >> 16;
+        memcpy(transitionFrame, frame_row(NUM_ROWS - shift), sizeof(CRGB) * NUM_COLS * shift);
+        memcpy(&transitionFrame[shift * NUM_COLS], &transitionFrom[shift * NUM_COLS], sizeof(CRGB) * NUM_COLS * (NUM_ROWS - shift));
+        break;
+    }
+    default:
+    {
+        // sweep a soft edge across the mask: pixels whose order is behind the edge show
+        // the new frame, ahead of it the old one and in between a blend of the two
+        int32_t sweep = ((uint32_t)progress * (256 + transitionEdge)) >> 16;
+        for (uint16_t i = 0; i < NUM_LEDS; i++)
+        {
+            int32_t amount = ((sweep - transitionMask[i]) * transitionEdgeScale) >> 8;
+            if (amount <= 0)
+                transitionFrame[i] = transitionFrom[i];
+            else if (amount >= 256)
+                transitionFrame[i] = leds[i];
+            else
+                transitionFrame[i] = mix(transitionFrom[i], leds[i], amount);
+        }
+        break;
+    }
+    }
+
+    return transitionFrame;
 }
-#endif
@@ -11,26 +11,88 @@
 // FastLED.Show every loop. Maintain a 'dirty' bit so we know when to call Show.
 extern boolean leds_dirty;
 
+// Select how the LED strips are wired to the XY matrix (see XYmap.h)
+#define BOTTOM_RIGHT
+// #define TOP_LEFT
+// #define COMPLEX_SHAPE
+
+#ifdef COMPLEX_SHAPE
+// four strips folded into the triangle columns of a hexagon (strips 1 and 2 are only 144 long)
+#define NUM_STRIPS 4
+#define NUM_LEDS_PER_STRIP 156
+#define NUM_COLS 20
+#define NUM_ROWS 39
+#else
+#define NUM_COLS 19
+#define NUM_ROWS 19
+
+// The rows are split into bands of whole rows, one per strip, and each strip is driven
+// from its own pin (see LED_STRIP_PIN_x in main.cpp and StripRows in XYmap.h). FastLED's
+// RMT driver sends all the strips at the same time so a frame takes roughly 1/NUM_STRIPS
+// as long to show. Override with -D NUM_STRIPS=n (1..4) to match how the panel is wired.
+#ifndef NUM_STRIPS
 #define NUM_STRIPS 1
-#define NUM_LEDS_PER_STRIP 361
-extern CRGB leds[];
+#endif
+#if NUM_STRIPS < 1 || NUM_STRIPS > 4
+#error "NUM_STRIPS must be between 1 and 4"
+#endif
+#define ROWS_PER_STRIP ((NUM_ROWS + NUM_STRIPS - 1) / NUM_STRIPS)
+#define NUM_LEDS_PER_STRIP (ROWS_PER_STRIP * NUM_COLS)
+#endif // COMPLEX_SHAPE
 
 // The width and height of the XY coordinate system. The corners outside the hexagon
 // are 'missing' so can't display any values assigned to them.
-#define NUM_COLS 19
-#define NUM_ROWS 19
 #define WIDTH NUM_COLS
 #define HEIGHT NUM_ROWS
-#define NUM_LEDS (NUM_STRIPS * NUM_LEDS_PER_STRIP)
-#define OUTOFBOUNDS (NUM_STRIPS * NUM_LEDS_PER_STRIP)
 
-// function to map a x, y coordinate to the index into the led array
-// origin (x = 0, y = 0) is at top left
-uint16_t XY(uint16_t x, uint16_t y);
+// Modes draw into a logical, row-major WIDTH x HEIGHT frame buffer so whole rows are
+// contiguous in memory. It is converted to the wiring order of the strips in one pass
+// just before it is shown (see render_show()).
+#define NUM_LEDS (NUM_COLS * NUM_ROWS)
+#define OUTOFBOUNDS NUM_LEDS
+extern CRGB leds[];
+
+// the physical LEDs in strip wiring order. There are two frames so the output task can
+// transmit one while the next is being converted (see render_setup()).
+#define NUM_PHYSICAL_LEDS (NUM_STRIPS * NUM_LEDS_PER_STRIP)
+#define PHYSICAL_OUTOFBOUNDS NUM_PHYSICAL_LEDS
+#define NUM_PHYSICAL_FRAMES 2
+extern CRGB physical_leds[NUM_PHYSICAL_FRAMES][NUM_PHYSICAL_LEDS + 1];
+
+// XY() and the compile time wiring tables
+#include "XYmap.h"
 
-// function to set an LED at (x,y) to a blended clock color
+// pointer to the first pixel of row y in the frame buffer
+inline CRGB *frame_row(uint16_t y)
+{
+  return &leds[y * NUM_COLS];
+}
+
+// turn off every pixel in the frame buffer
+void frame_clear();
+
+// Color correction and gamma applied (with the brightness) as frames are shown. A gamma
+// of 1.0 leaves the colors as the modes drew them.
+#define OUTPUT_CORRECTION TypicalLEDStrip
+#define OUTPUT_GAMMA 1.0f
+
+// start the LED output task (call after the strips have been added to FastLED)
+void render_setup();
+
+// convert the frame buffer to corrected colors in wiring order and queue it for the output
+// task. Frames whose contents (and brightness) match the last frame shown are skipped.
+void render_show();
+
+// how many frames render_show() has sent to the LEDs vs skipped as unchanged
+typedef struct
+{
+    uint32_t shown;
+    uint32_t skipped;
+} render_stats_t;
+render_stats_t render_get_stats();
+
+// function called for each LED (x,y) of a shape (see displaynumbers.h)
 typedef void (*setLEDFunction)(int x, int y);
-void setLEDBlendClockColor(int x, int y);
 
 typedef enum
 {
@@ -46,7 +108,11 @@ typedef enum
     RANDOM,             // Randomly selects a transition for each
 } TRANSITION_TYPE;
 
-void set_transition(TRANSITION_TYPE type, CRGB *leds);
-void transition_drawframe();
+// start a transition from 'from' (normally the last frame of the old mode) to whatever
+// is drawn into leds[] over the next second. SIMPLE_CUT cancels any running transition.
+void set_transition(TRANSITION_TYPE type, const CRGB *from);
+
+// the frame render_show() should display: leds, or the transition composite while one is running
+const CRGB *transition_drawframe();
 
 #endif // RENDER_H
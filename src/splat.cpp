@@ -0,0 +1,74 @@
+#include "main.h"
+#include "render.h"
+#include "splat.h"
+
+// marble positions are rounded to 1/16th of an LED
+#define SUBPIXEL_BITS 4
+#define SUBPIXELS (1 << SUBPIXEL_BITS)
+
+// How much of each of the four LEDs a one LED wide marble covers for every subpixel
+// offset (u, v) of its top left corner: [0] = (x, y), [1] = (x + 1, y), [2] = (x, y + 1)
+// and [3] = (x + 1, y + 1). The weights of each entry add up to 256.
+struct SplatCoverage
+{
+    uint16_t weight[SUBPIXELS][SUBPIXELS][4];
+};
+
+constexpr SplatCoverage makeSplatCoverage()
+{
+    SplatCoverage table = {};
+    for (uint16_t v = 0; v < SUBPIXELS; v++)
+    {
+        for (uint16_t u = 0; u < SUBPIXELS; u++)
+        {
+            table.weight[v][u][0] = (SUBPIXELS - u) * (SUBPIXELS - v);
+            table.weight[v][u][1] = u * (SUBPIXELS - v);
+            table.weight[v][u][2] = (SUBPIXELS - u) * v;
+            table.weight[v][u][3] = u * v;
+        }
+    }
+    return table;
+}
+
+static constexpr SplatCoverage Coverage = makeSplatCoverage();
+
+void splat_marbles(CRGB *frame, const splat_t *marbles, int count, SPLAT_MODE mode)
+{
+    for (int m = 0; m < count; m++)
+    {
+        // fixed point position of the marble's top left LED and the subpixel offset into it
+        int32_t fx = lroundf(marbles[m].x * SUBPIXELS);
+        int32_t fy = lroundf(marbles[m].y * SUBPIXELS);
+        int16_t x = fx >> SUBPIXEL_BITS;
+        int16_t y = fy >> SUBPIXEL_BITS;
+        const uint16_t *weight = Coverage.weight[fy & (SUBPIXELS - 1)][fx & (SUBPIXELS - 1)];
+        const CRGB &color = marbles[m].color;
+
+        for (uint8_t corner = 0; corner < 4; corner++)
+        {
+            uint16_t w = weight[corner];
+            uint16_t cx = x + (corner & 1);
+            uint16_t cy = y + (corner >> 1);
+
+            // negative values wrap to large unsigned values
+            if (w == 0 || cx >= NUM_COLS || cy >= NUM_ROWS)
+                continue;
+
+            CRGB c((color.r * w) >> 8, (color.g * w) >> 8, (color.b * w) >> 8);
+            CRGB &led = frame[cy * NUM_COLS + cx];
+            if (mode == SPLAT_ADD)
+            {
+                led += c;
+            }
+            else
+            {
+                if (c.r > led.r)
+                    led.r = c.r;
+                if (c.g > led.g)
+                    led.g = c.g;
+                if (c.b > led.b)
+                    led.b = c.b;
+            }
+        }
+    }
+}
@@ -0,0 +1,32 @@
+#ifndef SPLAT_H
+#define SPLAT_H
+
+#include "render.h" // for CRGB
+
+//
+// Antialiased marble drawing. Rather than snapping a marble to the nearest LED, its
+// color is spread over the (up to) four LEDs it overlaps, weighted by how much of
+// each one it covers, so slow moving marbles glide between LEDs instead of jumping.
+//
+
+// a marble to draw, in LED coordinates: (0, 0) is the center of the top left LED
+// and y increases downward (use HEIGHT - position.y for Box2D bodies)
+typedef struct
+{
+    float x;
+    float y;
+    CRGB color;
+} splat_t;
+
+// how a marble combines with what is already in the frame
+typedef enum
+{
+    SPLAT_ADD, // saturating add, overlapping marbles get brighter
+    SPLAT_MAX, // per channel maximum, overlapping marbles don't blow out to white
+} SPLAT_MODE;
+
+// draw all the marbles into frame (NUM_COLS x NUM_ROWS) in one pass. Marbles (or the
+// parts of them) outside the frame are clipped.
+void splat_marbles(CRGB *frame, const splat_t *marbles, int count, SPLAT_MODE mode = SPLAT_ADD);
+
+#endif // SPLAT_H
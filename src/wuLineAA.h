@@ -18,7 +18,8 @@ void crossfade(CRGB *a, const CRGB *b, uint8_t amount)
     a->blue = (a->blue * amount + b->blue * rev) >> 8;
 }
 
-void wuLineAA(saccum78 x1, saccum78 y1, saccum78 x2, saccum78 y2, CRGB *col)
+// draw an antialiased line into frame (which needs the hidden pixel at OUTOFBOUNDS)
+void wuLineAA(CRGB *frame, saccum78 x1, saccum78 y1, saccum78 x2, saccum78 y2, CRGB *col)
 {
     saccum78 grad, xd;
     saccum78 xend, yend, yf;
@@ -104,9 +105,9 @@ void wuLineAA(saccum78 x1, saccum78 y1, saccum78 x2, saccum78 y2, CRGB *col)
     coverage = ((yend & 0xff) * xgap) >> 8;
     ix1 = xend >> 8;
     // *col = 0xff0000;
-    crossfade(&leds[xyfunc(ix1, (yend >> 8))], col, coverage);
+    crossfade(&frame[xyfunc(ix1, (yend >> 8))], col, coverage);
     // *col = 0x00ff00;
-    crossfade(&leds[xyfunc(ix1, (yend >> 8) + 1)], col, 255 - coverage);
+    crossfade(&frame[xyfunc(ix1, (yend >> 8) + 1)], col, 255 - coverage);
 
     ix1++;
     yf = yend + grad;
@@ -123,16 +124,16 @@ void wuLineAA(saccum78 x1, saccum78 y1, saccum78 x2, saccum78 y2, CRGB *col)
 
     ix2 = xend >> 8;
     // *col = 0x0000ff;
-    crossfade(&leds[xyfunc(ix2, (yend >> 8))], col, coverage);
+    crossfade(&frame[xyfunc(ix2, (yend >> 8))], col, coverage);
     // *col = 0xff00ff;
-    crossfade(&leds[xyfunc(ix2, (yend >> 8) + 1)], col, 255 - coverage);
+    crossfade(&frame[xyfunc(ix2, (yend >> 8) + 1)], col, 255 - coverage);
     // *col = 0xffffff;
 
     while (ix1 < ix2)
     {
         coverage = yf & 0xff;
-        crossfade(&leds[xyfunc(ix1, yf >> 8)], col, coverage);
-        crossfade(&leds[xyfunc(ix1, (yf >> 8) + 1)], col, 255 - coverage);
+        crossfade(&frame[xyfunc(ix1, yf >> 8)], col, coverage);
+        crossfade(&frame[xyfunc(ix1, (yf >> 8) + 1)], col, 255 - coverage);
         yf += grad;
         ix1++;
     }
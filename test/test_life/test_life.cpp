@@ -0,0 +1,122 @@
+//
+// Host test for the bitsliced Life stepper: pio test -e native
+//
+// Random soups are stepped with life_step() and with a cell by cell reference
+// and must match every generation, on several board sizes with wrapped and
+// bounded edges.
+//
+#include <unity.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "life.h"
+
+#define SOUPS 500      // per board size and edge mode
+#define GENERATIONS 30 // per soup
+
+static const struct
+{
+    size_t width, height;
+} boards[] = {{3, 3}, {5, 7}, {8, 8}, {16, 9}, {19, 19}, {31, 12}, {32, 5}, {32, 32}};
+
+// xorshift32 so every run tests the same soups
+static uint32_t random_state = 2463534242u;
+static uint32_t random32()
+{
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    return random_state;
+}
+
+// B3/S23 one cell at a time, bit x of rows[y] is the cell at (x, y)
+static bool reference_cell(const uint32_t *rows, int width, int height, bool torus, int x, int y)
+{
+    if (torus)
+    {
+        x = (x + width) % width;
+        y = (y + height) % height;
+    }
+    else if (x < 0 || x >= width || y < 0 || y >= height)
+    {
+        return false;
+    }
+    return (rows[y] >> x) & 1;
+}
+
+static void reference_step(const uint32_t *rows, uint32_t *next, int width, int height, bool torus)
+{
+    for (int y = 0; y < height; y++)
+    {
+        next[y] = 0;
+        for (int x = 0; x < width; x++)
+        {
+            int neighbors = 0;
+            for (int dy = -1; dy <= 1; dy++)
+                for (int dx = -1; dx <= 1; dx++)
+                    if (dx || dy)
+                        neighbors += reference_cell(rows, width, height, torus, x + dx, y + dy);
+
+            bool alive = (rows[y] >> x) & 1;
+            if (neighbors == 3 || (alive && neighbors == 2))
+                next[y] |= 1u << x;
+        }
+    }
+}
+
+static void test_step_matches(bool torus)
+{
+    uint32_t expected[32], scratch[32];
+    char message[96];
+
+    for (const auto &board : boards)
+    {
+        life_t *life = life_create(board.width, board.height, torus);
+        TEST_ASSERT_NOT_NULL(life);
+        uint32_t mask = board.width == 32 ? UINT32_MAX : (1u << board.width) - 1;
+
+        for (int soup = 0; soup < SOUPS; soup++)
+        {
+            uint32_t *rows = life_rows(life);
+            for (size_t y = 0; y < board.height; y++)
+                rows[y] = expected[y] = random32() & mask;
+
+            for (int generation = 1; generation <= GENERATIONS; generation++)
+            {
+                life_step(life);
+                reference_step(expected, scratch, board.width, board.height, torus);
+                memcpy(expected, scratch, board.height * sizeof(uint32_t));
+
+                rows = life_rows(life);
+                for (size_t y = 0; y < board.height; y++)
+                {
+                    snprintf(message, sizeof(message), "%ux%u %s, soup %d, generation %d, row %u",
+                             (unsigned)board.width, (unsigned)board.height, torus ? "torus" : "bounded", soup, generation, (unsigned)y);
+                    TEST_ASSERT_EQUAL_HEX32_MESSAGE(expected[y], rows[y], message);
+                }
+            }
+        }
+        life_destroy(life);
+    }
+}
+
+static void test_step_torus()
+{
+    test_step_matches(true);
+}
+
+static void test_step_bounded()
+{
+    test_step_matches(false);
+}
+
+void setUp() {}
+void tearDown() {}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_step_torus);
+    RUN_TEST(test_step_bounded);
+    return UNITY_END();
+}